@@ -2,7 +2,8 @@
 #include <iostream>
 #include <vector>
 #include "token.h"
-#include <stdexcept>
+#include <charconv>
+#include <algorithm>
 
 
 /*
@@ -18,10 +19,84 @@
 			production
 */
 
-void Parser::setTokens(std::vector<Token> inTokens) {
+Parser::Parser() {
+	debug = false;
+	tokenList = &tokens;
+	pool = nullptr;
+	errorCount = 0;
+	currPos = 0;
+	streaming = false;
+	currentPrintIndent = 0;
+	ssa = nullptr;
+	constTable = nullptr;
+	constBlock = nullptr;
+	elseHead = nullptr;
+	joinBlockHead = nullptr;
+	joinBlock = nullptr;
+}
+
+Parser::~Parser() {
+	clearSSAs();
+}
+
+// each SSA owns the arena holding its values and blocks, so this releases
+// everything the last compilation made
+void Parser::clearSSAs() {
+	for (auto kv : programSSAs) {
+		delete kv.second;
+	}
+	programSSAs.clear();
+	ssa = nullptr;
+}
+
+std::vector<SSA*> Parser::getSSAs() {
+	std::vector<SSA*> ssas;
+	for (auto kv : programSSAs) {
+		ssas.push_back(kv.second);
+	}
+	return ssas;
+}
+
+void Parser::countAllocations(size_t& objects, size_t& blocks) {
+	objects = 0;
+	blocks = 0;
+	for (auto kv : programSSAs) {
+		objects += kv.second->getArena().objectCount();
+		blocks += kv.second->getArena().blockCount();
+	}
+}
+
+void Parser::setTokens(const std::vector<Token>& inTokens, TokenPool* inPool) {
 	tokens = inTokens;
+	tokenList = &tokens;
+	pool = inPool;
+	currPos = 0;
+	streaming = false;
+}
+
+void Parser::setIncremental(Lexer* lex) {
+	tokens.clear();
+	tokenList = &lex->getTokens();
+	pool = lex->getPool();
+	currPos = 0;
+	streaming = false;
+}
+
+void Parser::setLexer(Lexer* lex) {
+	tokens.clear();
+	cursor.setLexer(lex);
+	pool = lex->getPool();
 	currPos = 0;
+	streaming = true;
+}
 
+void Parser::setGenerator(Lexer* lex) {
+	tokens.clear();
+	generator = lex->generateTokens();
+	cursor.setGenerator(&generator);
+	pool = lex->getPool();
+	currPos = 0;
+	streaming = true;
 }
 
 void Parser::setDebug(bool debugMode) {
@@ -30,19 +105,30 @@ void Parser::setDebug(bool debugMode) {
 
 
 void Parser::next() {
-	if (currPos < tokens.size() - 1) {
+	if (streaming) {
+		cursor.advance();
+		sym = cursor.current().getType();
+	} else if (currPos < tokenList->size() - 1) {
 		currPos += 1;
-		sym = tokens[currPos].getType();
+		sym = (*tokenList)[currPos].getType();
+	}
+}
+
+const Token& Parser::currentToken() {
+	if (streaming) {
+		return cursor.current();
 	}
+	return (*tokenList)[currPos];
 }
 
-std::string Parser::getCurrentValue() {
-	return tokens[currPos].getValue();
+std::string_view Parser::getCurrentValue() {
+	return pool->getValue(currentToken());
 }
 
 
 
 void Parser::error(std::string errorMessage) {
+	errorCount += 1;
 	std::cout << "Parser Error: " << errorMessage << std::endl;
 }
 
@@ -58,7 +144,7 @@ void Parser::decPrintInd() {
 	currentPrintIndent -= 1;
 }
 
-void Parser::printItem(std::string item, std::string value) {
+void Parser::printItem(std::string item, std::string_view value) {
 	if (debug) {
 		incPrintInd();
 		std::cout << createIndent() << item << " " << value << std::endl;
@@ -76,7 +162,7 @@ void Parser::startPrintBlock(std::string blockName) {
 SSAValue* Parser::varRef() {
 	startPrintBlock("Var Ref");
 
-	std::string ident = getCurrentValue();
+	std::string ident(getCurrentValue());
 	printItem("Identifier", ident);
 	SSAValue* identInst = ssa->findSymbol(ident);
 	//identInst->setNameType(ident, true);
@@ -92,13 +178,17 @@ std::tuple<SSAValue*, std::string> Parser::factor() {
 	SSAValue* left;
 	std::string name = "";
 	if (sym == IDENT) {
-		name = getCurrentValue();
+		name = std::string(getCurrentValue());
 		left = varRef();
 	}
 	else if (sym == NUMBER) {
-		std::string numStr = getCurrentValue();
+		std::string_view numStr = getCurrentValue();
 		printItem("Number", numStr);
-		int num = stoi(numStr);
+		int num = 0;
+		std::from_chars_result res = std::from_chars(numStr.data(), numStr.data() + numStr.size(), num);
+		if (res.ec != std::errc()) {
+			error("Number out of range");
+		}
 		left = ssa->SSACreateConst(num);
 		//left->setNameType("#" + numStr, false);
 		next();
@@ -126,7 +216,7 @@ std::tuple<SSAValue*, std::string> Parser::factor() {
 	else {
 		error("No Production Exists for your input");
 		// TODO
-		left = new SSAValue();
+		left = ssa->allocSSAValue();
 	}
 	
 	decPrintInd();
@@ -253,7 +343,7 @@ void Parser::assignment() {
 		printItem(getTextForEnum(sym));
 		next(); // consume LET
 		if (sym == IDENT) {
-			identName = getCurrentValue();
+			identName = std::string(getCurrentValue());
 			printItem(getTextForEnum(sym), identName);
 
 			next(); // consume IDENT
@@ -294,7 +384,7 @@ SSAValue* Parser::funcCall() {
 		next();
 		if (sym == IDENT) {
 			printItem(getTextForEnum(sym), getCurrentValue());
-			std::string ident = getCurrentValue();
+			std::string ident(getCurrentValue());
 			funcDescriptor funcToCall = funcDescriptors.at(ident);
 			isVoid = funcToCall.isVoid;
 			formalParams = funcToCall.formalParams;
@@ -374,10 +464,10 @@ void Parser::ifStatement() {
 
 	SSAValue* savedElseHead = elseHead;
 	SSAValue* savedJoinBlockHead = joinBlockHead;
-	std::unordered_map<std::string, SSAValue*> savedPhiMap = phiMap;
+	size_t savedScopeDefs = scopeDefs.size();
 	BasicBlock* savedJoinBlock = joinBlock;
 	joinBlock = ssa->createBlock();
-	ssa->setJoinType(joinBlock, "if");
+	ssa->setJoinType(joinBlock, JOIN_IF);
 
 	//ssa->connectFT(joinBlock, savedJoinBlock);
 
@@ -386,7 +476,7 @@ void Parser::ifStatement() {
 		next();
 		relation();
 		BasicBlock* splitBlock = ssa->getContext();
-		splitBlock->splitType = "if";
+		splitBlock->splitType = SPLIT_IF;
 		// remember split block
 		// create fall through block
 		// connect split to fall through block
@@ -396,12 +486,12 @@ void Parser::ifStatement() {
 			printItem(getTextForEnum(sym));
 			next();
 
-			phiMap = std::unordered_map<std::string, SSAValue*>();
 			thenBlock = ssa->createContext();
 			thenBlock->dom = splitBlock;
 			statSequence();
 			ssa->connectFT(splitBlock, thenBlock);
-			std::unordered_map<std::string, SSAValue*> thenPhiMap = phiMap;
+			// then assignments are scopeDefs[savedScopeDefs, thenEnd)
+			size_t thenEnd = scopeDefs.size();
 
 
 			if (sym == ELSE) {
@@ -418,14 +508,18 @@ void Parser::ifStatement() {
 				printItem(getTextForEnum(sym));
 				next();
 
-				phiMap = std::unordered_map<std::string, SSAValue*>();
-				
 				joinBlock->ifThenJoinBlock = true;
 				statSequence();
 
 				ssa->connectBR(splitBlock, elseBlock);
 				
-				std::unordered_map<std::string, SSAValue*> elsePhiMap = phiMap;
+				// else assignments are everything after thenEnd
+				if ((int)elseDefs.size() < ssa->varCount()) {
+					elseDefs.resize(ssa->varCount(), nullptr);
+				}
+				for (size_t i = thenEnd; i < scopeDefs.size(); i++) {
+					elseDefs[scopeDefs[i].var] = scopeDefs[i].value;
+				}
 				
 				ssa->initBlock(joinBlock);
 				ssa->setContext(joinBlock);
@@ -439,27 +533,32 @@ void Parser::ifStatement() {
 
 				//joinBlock = ssa->createContext();
 				ssa->connectBR(thenBlock, joinBlock);
-				thenBlock->conditionalBlockType = "ifThenElse-Then";
+				thenBlock->conditionalBlockType = IF_THEN_ELSE_THEN;
 				ssa->connectFT(elseBlock, joinBlock);
-				elseBlock->conditionalBlockType = "ifThenElse-Else";
-				for (auto kv : thenPhiMap) {
-					try {
-						SSAValue* val = elsePhiMap.at(kv.first);
-						ssa->SSACreate(PHI, kv.second, val);
-						elsePhiMap.erase(kv.first);
-						ssa->addSymbol(kv.first, ssa->getTail());
-					}
-					catch (std::out_of_range& oor) {
-						SSAValue* prevOccur = ssa->findSymbol(kv.first);
-						ssa->SSACreate(PHI, kv.second, prevOccur);
-						ssa->addSymbol(kv.first, ssa->getTail());
+				elseBlock->conditionalBlockType = IF_THEN_ELSE_ELSE;
+				for (size_t i = savedScopeDefs; i < thenEnd; i++) {
+					scopeDef def = scopeDefs[i];
+					SSAValue* elseVal = elseDefs[def.var];
+					if (elseVal != nullptr) {
+						ssa->SSACreate(PHI, def.value, elseVal);
+						elseDefs[def.var] = nullptr;
+						ssa->addSymbol(def.var, ssa->getTail());
+					} else {
+						SSAValue* prevOccur = ssa->findSymbol(def.var);
+						ssa->SSACreate(PHI, def.value, prevOccur);
+						ssa->addSymbol(def.var, ssa->getTail());
 
 					}
 				}
-				for (auto kv : elsePhiMap) {
-					SSAValue* prevOccur = ssa->findSymbol(kv.first);
-					ssa->SSACreate(PHI, prevOccur, kv.second);
-					ssa->addSymbol(kv.first, ssa->getTail());
+				for (size_t i = thenEnd; i < scopeDefs.size(); i++) {
+					scopeDef def = scopeDefs[i];
+					if (elseDefs[def.var] == nullptr) {
+						continue; // merged with the then value above
+					}
+					elseDefs[def.var] = nullptr;
+					SSAValue* prevOccur = ssa->findSymbol(def.var);
+					ssa->SSACreate(PHI, prevOccur, def.value);
+					ssa->addSymbol(def.var, ssa->getTail());
 
 				}
 			} else {
@@ -475,15 +574,16 @@ void Parser::ifStatement() {
 				//joinBlock = ssa->createContext();
 				ssa->updateNop(elseHead);
 				ssa->connectFT(thenBlock, joinBlock);
-				thenBlock->conditionalBlockType = "ifThen-Then";
+				thenBlock->conditionalBlockType = IF_THEN_THEN;
 				ssa->connectBR(splitBlock, ssa->getContext());
 				ssa->getContext()->alreadyConnected = true;
 				ssa->getContext()->alreadyConnectedBranch = true;
 
-				for (auto kv : thenPhiMap) {
-					SSAValue* prevOccur = ssa->findSymbol(kv.first);
-					ssa->SSACreate(PHI, kv.second, prevOccur);
-					ssa->addSymbol(kv.first, ssa->getTail());
+				for (size_t i = savedScopeDefs; i < thenEnd; i++) {
+					scopeDef def = scopeDefs[i];
+					SSAValue* prevOccur = ssa->findSymbol(def.var);
+					ssa->SSACreate(PHI, def.value, prevOccur);
+					ssa->addSymbol(def.var, ssa->getTail());
 
 				}
 			}
@@ -500,24 +600,24 @@ void Parser::ifStatement() {
 		error("If statement must have 'if'");
 	}
 
-	if (savedJoinBlock != nullptr && savedJoinBlock->joinType != "while") {
+	if (savedJoinBlock != nullptr && savedJoinBlock->joinType != JOIN_WHILE) {
 		if (savedJoinBlock->ifThenJoinBlock == true) {
 			// outer conditional is if then else
-			BasicBlock* prevFTBlock = savedJoinBlock->fallThroughFrom;
-			savedJoinBlock->fallThroughFrom = nullptr;
+			BasicBlock* prevFTBlock = savedJoinBlock->pred[EDGE_FT];
+			savedJoinBlock->pred[EDGE_FT] = nullptr;
 			if (prevFTBlock != nullptr) {
-				prevFTBlock->fallThrough = nullptr;
-				prevFTBlock->conditionalBlockType = "ifThenElse-Then";
+				prevFTBlock->succ[EDGE_FT] = nullptr;
+				prevFTBlock->conditionalBlockType = IF_THEN_ELSE_THEN;
 
 			}
 			ssa->connectBR(prevFTBlock, savedJoinBlock);
 			ssa->connectFT(joinBlock, savedJoinBlock);
-			joinBlock->conditionalBlockType = "ifThenElse-Else";
+			joinBlock->conditionalBlockType = IF_THEN_ELSE_ELSE;
 
 		} else {
 			// outer condition is if then
 			ssa->connectFT(joinBlock, savedJoinBlock);
-			joinBlock->conditionalBlockType = "ifThen-Then";
+			joinBlock->conditionalBlockType = IF_THEN_THEN;
 			savedJoinBlock->alreadyConnected = true;
 		}
 	}
@@ -525,7 +625,7 @@ void Parser::ifStatement() {
 	elseHead = savedElseHead;
 	joinBlockHead = savedJoinBlockHead;
 	joinBlock = savedJoinBlock;
-	phiMap = savedPhiMap;
+	scopeDefs.resize(savedScopeDefs);
 	decPrintInd();
 }
 
@@ -534,28 +634,30 @@ void Parser::whileStatement() {
 
 	SSAValue* savedElseHead = elseHead;
 	SSAValue* savedJoinBlockHead = joinBlockHead;
-	std::unordered_map<std::string, SSAValue*> savedPhiMap = phiMap;
+	size_t savedScopeDefs = scopeDefs.size();
 	BasicBlock* savedJoinBlock = joinBlock;
-	bool savedInWhile = ssa->getInWhile();
 	//joinBlock = ssa->createBlock();
 	//ssa->initBlock(joinBlock);
 	//ssa->setContext(joinBlock);
-	ssa->setInWhile(true);
 	BasicBlock* followBlock = nullptr;
 	joinBlock = ssa->getContext();
-	ssa->setJoinType(joinBlock, "while");
+	ssa->setJoinType(joinBlock, JOIN_WHILE);
 	if (sym == WHILE) {
 		printItem(getTextForEnum(sym));
 		next();
-		SSAValue* branchInst = relation();
+		// variables read from here on get the header's phi, the condition
+		// is part of the loop too. the back edge goes to the nop, so the
+		// whole condition is evaluated again
+		ssa->enterLoop();
+		joinBlockHead = ssa->SSACreateNop();
+		ssa->updateNop(joinBlockHead);
+		relation();
 		BasicBlock* whileBodyBlock = ssa->createContext();
 		whileBodyBlock->dom = joinBlock;
-		joinBlockHead = ssa->SSACreateNop();
 
 		if (sym == DO) {
 			printItem(getTextForEnum(sym));
 			next();
-			phiMap = std::unordered_map<std::string, SSAValue*>();
 			SSAValue* whileBodyHead = ssa->SSACreateNop();
 			ssa->updateNop(whileBodyHead);
 			statSequence();
@@ -568,172 +670,42 @@ void Parser::whileStatement() {
 
 			// at this point, we are in the scope immediately outside of while body
 			// for every assignment inside of while body
-			//     create a phi instruction in the join block with assignment from while body on left, and most recent outer assignment on right
+			//     complete the phi in the join block with assignment from while body on right, and most recent outer assignment on left
+			//     (the body already refers to the phis of variables it read before assigning them)
 			//	
-			std::unordered_map<std::string, SSAValue*> whilePhiMap = phiMap; // scope symbol table of while body
+			// the while body's assignments are scopeDefs[savedScopeDefs, end)
 			ssa->connectFT(joinBlock, whileBodyBlock);
 			//ssa->connectBR(ssa->getContext(), joinBlock);
 			ssa->connectLoop(ssa->getContext(), joinBlock);
 			
 			ssa->setContext(joinBlock, true);
-			ssa->updateNop(joinBlockHead);
 
 			SSAValue* joinBlockTail = joinBlockHead;
-			                   // argName         // prevId       // changeToID
-			std::unordered_map<std::string, std::tuple<SSAValue*, SSAValue*>> idChanges;
-			//std::unordered_map<SSAValue*, SSAValue*> idChanges;
-			for (auto kv : whilePhiMap) {
-				SSAValue* prevOccur = ssa->findSymbol(kv.first); // outer scope value
-				SSAValue* phiInst = ssa->SSACreate(PHI, prevOccur, kv.second); 
-				std::tuple<SSAValue*, SSAValue*> replaceInfo = std::make_tuple(prevOccur, phiInst);
-				idChanges.insert_or_assign(kv.first, replaceInfo); 
+			for (size_t i = savedScopeDefs; i < scopeDefs.size(); i++) {
+				scopeDef def = scopeDefs[i];
+				SSAValue* phiInst = ssa->SSACreateLoopPhi(def.var, def.value);
 				joinBlockTail = phiInst;
-				ssa->addSymbol(kv.first, ssa->getTail());
-			}
-
-			SSAValue* aboveCmpInst = branchInst->prev->prev;
-
-
-			SSAValue* cmpInst = branchInst->prev;
-			SSAValue* cmpLeftOp = cmpInst->operand1;
-			SSAValue* cmpRightOp = cmpInst->operand2;
-			//cmpLeftOp->instRepr();
-			try {
-				std::string cmpLeftName = cmpInst->op1Name;
-				std::tuple<SSAValue*, SSAValue*> replaceInfo = idChanges.at(cmpLeftName);
-				if (cmpLeftOp == std::get<0>(replaceInfo)) {
-					cmpInst->operand1 = std::get<1>(replaceInfo);
-				}
-			} catch (std::out_of_range& oor) {
-				// intentionally left blank
-			}
-
-			try {
-				std::string cmpRightName = cmpInst->op2Name;
-				std::tuple<SSAValue*, SSAValue*> replaceInfo = idChanges.at(cmpRightName);
-				if (cmpRightOp == std::get<0>(replaceInfo)) {
-					cmpInst->operand2 = std::get<1>(replaceInfo);
-				}
+				ssa->addSymbol(def.var, phiInst);
 			}
-			catch (std::out_of_range& oor) {
-				// intentionally left blank
+			ssa->exitLoop();
+
+			// move the phis from the tail to right after the nop
+			if (joinBlockTail != joinBlockHead) {
+				SSAValue* firstPhi = whileBodyTail->next;
+				SSAValue* conditionHead = joinBlockHead->next;
+				joinBlockHead->next = firstPhi;
+				firstPhi->prev = joinBlockHead;
+				joinBlockTail->next = conditionHead;
+				conditionHead->prev = joinBlockTail;
+				whileBodyTail->next = nullptr;
+				ssa->setInstTail(whileBodyTail);
 			}
 
-
-			aboveCmpInst->next = joinBlockHead;
-			joinBlockHead->prev = aboveCmpInst;
-
-
-
-			joinBlockTail->next = cmpInst;
-			cmpInst->prev = joinBlockTail;
-
-			branchInst->next = whileBodyHead;
-			whileBodyHead->prev = branchInst;
-
-			ssa->setInstTail(whileBodyTail);
-
 			followBlock = ssa->createContext(); // also does setContext
 			ssa->connectBR(joinBlock, followBlock);
 			followBlock->dom = joinBlock;
 			ssa->updateNop(elseHead);
 
-			SSAValue* ssaAtIndexInBody = whileBodyHead;
-			std::unordered_map<SSAValue*, SSAValue*> instReplacements;
-
-			while (ssaAtIndexInBody != whileBodyTail) {
-				SSAValue* leftOp = ssaAtIndexInBody->operand1;
-				SSAValue* rightOp = ssaAtIndexInBody->operand2;
-;
-				try {
-					std::string leftName = ssaAtIndexInBody->op1Name;
-					std::tuple<SSAValue*, SSAValue*> replaceInfo = idChanges.at(leftName);
-					if (leftOp == std::get<0>(replaceInfo)) {
-						ssaAtIndexInBody->operand1 = std::get<1>(replaceInfo);
-					}
-				}
-				catch (std::out_of_range& oor) {
-					// intentionally left blank
-				}
-
-				try {
-					std::string rightName = ssaAtIndexInBody->op2Name;
-					std::tuple<SSAValue*, SSAValue*> replaceInfo = idChanges.at(rightName);
-					if (rightOp == std::get<0>(replaceInfo)) {
-						ssaAtIndexInBody->operand2 = std::get<1>(replaceInfo);
-					}
-				}
-				catch (std::out_of_range& oor) {
-					// intentionally left blank
-				}
-
-				try {
-					SSAValue* replaceWith = instReplacements.at(ssaAtIndexInBody->operand1);
-					ssaAtIndexInBody->operand1 = replaceWith;
-				} catch (std::out_of_range& oor) {
-					// intentionally left blank
-				}
-				try {
-					SSAValue* replaceWith = instReplacements.at(ssaAtIndexInBody->operand2);
-					ssaAtIndexInBody->operand2 = replaceWith;
-				}
-				catch (std::out_of_range& oor) {
-					// intentionally left blank
-				}
-				SSAValue* iter = ssaAtIndexInBody->prevDomWithOpcode;
-				bool needToEliminate = false;
-				SSAValue* elimWith = nullptr;
-				while (iter != nullptr && !needToEliminate) {
-					if (iter->operand1 == ssaAtIndexInBody->operand1 && iter->operand2 == ssaAtIndexInBody->operand2) {
-						// eliminate
-						needToEliminate = true;
-						elimWith = iter;
-					}
-					iter = iter->prevDomWithOpcode;
-				}
-				if (needToEliminate) {
-					//SSAValue* beforeCurrent = ssaAtIndexInBody->prev;
-					SSAValue* afterCurrent = ssaAtIndexInBody->next;
-					//beforeCurrent->next = afterCurrent;
-					//afterCurrent->prev = beforeCurrent;
-					ssaAtIndexInBody->eliminated = true;
-
-					SSAValue* elimIter = elimWith;
-					while (elimIter->eliminatedBy != nullptr) {
-						elimIter = elimIter->eliminatedBy;
-					}
-
-					instReplacements.insert({ ssaAtIndexInBody, elimIter });
-					ssaAtIndexInBody->eliminatedBy = elimIter;
-					ssaAtIndexInBody = afterCurrent;
-				} else {
-					ssaAtIndexInBody = ssaAtIndexInBody->next;
-				}
-
-			}
-			// now rename operands of phis if needed
-
-			SSAValue* iter = joinBlockHead->next;
-			while (iter != joinBlockTail->next) {
-				try {
-					SSAValue* replaceWith = instReplacements.at(iter->operand1);
-					iter->operand1 = replaceWith;
-				}
-				catch (std::out_of_range& oor) {
-					// intentionally left blank
-				}
-				try {
-					SSAValue* replaceWith = instReplacements.at(iter->operand2);
-					iter->operand2 = replaceWith;
-				}
-				catch (std::out_of_range& oor) {
-					// intentionally left blank
-				}
-				iter = iter->next;
-			}
-
-
-
 			if (sym == OD) {
 				printItem(getTextForEnum(sym));
 				next();
@@ -741,24 +713,25 @@ void Parser::whileStatement() {
 				error("While statement must end in 'od'");
 			}
 		} else {
+			ssa->exitLoop();
 			error("While statement must have 'do'");
 		}
 	} else {
 		error("While statement must have 'while'");
 	}
 
-	//if (savedJoinBlock != nullptr && savedJoinBlock->joinType != "while") {
+	//if (savedJoinBlock != nullptr && savedJoinBlock->joinType != JOIN_WHILE) {
 
 	//	ssa->connectFT(followBlock, savedJoinBlock);
 	//}
 
-	if (savedJoinBlock != nullptr && savedJoinBlock->joinType != "while") {
+	if (savedJoinBlock != nullptr && savedJoinBlock->joinType != JOIN_WHILE) {
 		if (savedJoinBlock->ifThenJoinBlock == true) {
 			// outer conditional is if then else
-			BasicBlock* prevFTBlock = savedJoinBlock->fallThroughFrom;
-			savedJoinBlock->fallThroughFrom = nullptr;
+			BasicBlock* prevFTBlock = savedJoinBlock->pred[EDGE_FT];
+			savedJoinBlock->pred[EDGE_FT] = nullptr;
 			if (prevFTBlock != nullptr) {
-				prevFTBlock->fallThrough = nullptr;
+				prevFTBlock->succ[EDGE_FT] = nullptr;
 			}
 			ssa->connectBR(prevFTBlock, savedJoinBlock);
 			ssa->connectFT(followBlock, savedJoinBlock);
@@ -769,10 +742,9 @@ void Parser::whileStatement() {
 			savedJoinBlock->alreadyConnected = true;
 		}
 	}
-	ssa->setInWhile(savedInWhile);
 	elseHead = savedElseHead;
 	joinBlockHead = savedJoinBlockHead;
-	phiMap = savedPhiMap;
+	scopeDefs.resize(savedScopeDefs);
 	joinBlock = savedJoinBlock;
 
 	decPrintInd();
@@ -830,7 +802,7 @@ void Parser::statSequence() {
 
 		}
 	}
-	phiMap = ssa->exitScope();
+	ssa->exitScope(scopeDefs);
 
 
 	decPrintInd();
@@ -842,7 +814,7 @@ void Parser::varDecl() {
 		printItem(getTextForEnum(sym));
 		next();
 		if (sym == IDENT) {
-			ssa->addToVarDecl(getCurrentValue());
+			ssa->addToVarDecl(std::string(getCurrentValue()));
 			printItem(getTextForEnum(sym), getCurrentValue());
 
 			next();
@@ -850,7 +822,7 @@ void Parser::varDecl() {
 				printItem(getTextForEnum(sym));
 				next();
 				if (sym == IDENT) {
-					ssa->addToVarDecl(getCurrentValue());
+					ssa->addToVarDecl(std::string(getCurrentValue()));
 					printItem(getTextForEnum(sym), getCurrentValue());
 					next();
 				} else {
@@ -876,6 +848,7 @@ void Parser::varDecl() {
 void Parser::funcDecl() {
 
 	startPrintBlock("Function Declaration");
+	funcSpan span = { "", currPos, currPos, currPos };
 	bool isVoid = false;
 	if (sym == VOID) {
 		isVoid = true;
@@ -886,11 +859,13 @@ void Parser::funcDecl() {
 		printItem(getTextForEnum(sym));
 		next();
 		if (sym == IDENT) {
-			std::string ident = getCurrentValue();
+			std::string ident(getCurrentValue());
 			printItem(getTextForEnum(sym), getCurrentValue());
 			ssa = new SSA(ident);
 			programSSAs.insert({ ident, ssa });
 			next();
+			span.name = ident;
+			span.bodyStart = currPos;
 			std::vector<std::string> params = formalParam();
 			funcDescriptor newFunc = { isVoid, params };
 			funcDescriptors.insert({ ident, newFunc });
@@ -918,6 +893,8 @@ void Parser::funcDecl() {
 	}
 	decPrintInd();
 	ssa = programSSAs.at("__main__");
+	span.endToken = currPos;
+	funcSpans.push_back(span);
 }
 
 std::vector<std::string> Parser::formalParam() {
@@ -932,20 +909,22 @@ std::vector<std::string> Parser::formalParam() {
 		} else {
 			if (sym == IDENT) {
 				printItem(getTextForEnum(sym), getCurrentValue());
-				SSAValue* argVal = ssa->SSACreateArgAssign(getCurrentValue());
-				ssa->addToVarDecl(getCurrentValue());
-				ssa->addSymbol(getCurrentValue(), argVal);
-				formalParams.push_back(getCurrentValue());
+				std::string paramName(getCurrentValue());
+				SSAValue* argVal = ssa->SSACreateArgAssign(paramName);
+				int paramVar = ssa->addToVarDecl(paramName);
+				ssa->addSymbol(paramVar, argVal);
+				formalParams.push_back(paramName);
 				next();
 				while (sym == COMMA) {
 					printItem(getTextForEnum(sym));
 					next(); // consume COMMA
 					if (sym == IDENT) {
 						printItem(getTextForEnum(sym), getCurrentValue());
-						SSAValue* argVal = ssa->SSACreateArgAssign(getCurrentValue());
-						ssa->addToVarDecl(getCurrentValue());
-						ssa->addSymbol(getCurrentValue(), argVal);
-						formalParams.push_back(getCurrentValue());
+						std::string paramName(getCurrentValue());
+						SSAValue* argVal = ssa->SSACreateArgAssign(paramName);
+						int paramVar = ssa->addToVarDecl(paramName);
+						ssa->addSymbol(paramVar, argVal);
+						formalParams.push_back(paramName);
 						next(); // consume IDENT
 					} else {
 						error("Expected identifier here");
@@ -979,6 +958,7 @@ void Parser::funcBody() {
 		if ((sym == LET) || (sym == CALL) || (sym == IF) ||
 			(sym == WHILE) || (sym == RETURN)) {
 			statSequence();
+			scopeDefs.clear(); // nothing merges the function's own assignments
 		}
 		if (sym == R_BRACE) {
 			printItem(getTextForEnum(sym));
@@ -1011,6 +991,7 @@ void Parser::computation() {
 			printItem(getTextForEnum(sym));
 			next();
 			statSequence();
+			scopeDefs.clear();
 			if (sym == R_BRACE) {
 				printItem(getTextForEnum(sym));
 				next();
@@ -1037,6 +1018,13 @@ void Parser::parse() {
 	if (debug) {
 		std::cout << "Parser is starting..." << std::endl;
 	}
+	// parse() can run again on the same parser, see reparse()
+	clearSSAs();
+	funcDescriptors.clear();
+	funcSpans.clear();
+	scopeDefs.clear();
+	errorCount = 0;
+
 	ssa = new SSA("__main__");
 	programSSAs.insert({ "__main__", ssa });
 	funcDescriptor read = { false, std::vector<std::string>() };
@@ -1051,7 +1039,7 @@ void Parser::parse() {
 
 	currentPrintIndent = 0;
 	currPos = 0;
-	sym = tokens[currPos].getType();
+	sym = currentToken().getType();
 
 	computation();
 }
@@ -1060,6 +1048,67 @@ std::string Parser::outputSSA() {
 	return ssa->outputSSA();
 }
 
+std::string Parser::outputSSA(const std::string& funcName) {
+	return programSSAs.at(funcName)->outputSSA();
+}
+
+bool Parser::reparse(const tokenEdit& edit) {
+	int editEnd = edit.firstToken + edit.removedTokens;
+	int delta = edit.insertedTokens - edit.removedTokens;
+	if (edit.removedTokens == 0 && edit.insertedTokens == 0) {
+		// only whitespace or comments changed
+		return true;
+	}
+
+	// the edit has to stay inside of one function's body, its header and
+	// the closing ';' untouched. spans are in token order
+	int spanIndex = -1;
+	auto after = std::upper_bound(funcSpans.begin(), funcSpans.end(), edit.firstToken,
+		[](int firstToken, const funcSpan& span) { return firstToken < span.bodyStart; });
+	if (after != funcSpans.begin()) {
+		const funcSpan& span = *(after - 1);
+		if (edit.firstToken >= span.bodyStart && editEnd < span.endToken) {
+			spanIndex = (int)(after - 1 - funcSpans.begin());
+		}
+	}
+
+	if (spanIndex != -1) {
+		funcSpan old = funcSpans[spanIndex];
+		funcDescriptor oldDescriptor = funcDescriptors.at(old.name);
+		SSA* oldSSA = programSSAs.at(old.name);
+		programSSAs.erase(old.name);
+		funcDescriptors.erase(old.name);
+		int oldErrorCount = errorCount;
+
+		currPos = old.firstToken;
+		sym = currentToken().getType();
+		funcDecl();
+		funcSpan updated = funcSpans.back();
+		funcSpans.pop_back();
+
+		// anything that would change how the rest of the program parses
+		// means a full parse
+		bool sameShape = (updated.name == old.name) && (updated.endToken == old.endToken + delta) &&
+			(errorCount == oldErrorCount) && programSSAs.count(old.name) &&
+			(funcDescriptors.at(old.name).isVoid == oldDescriptor.isVoid) &&
+			(funcDescriptors.at(old.name).formalParams == oldDescriptor.formalParams);
+		if (sameShape) {
+			funcSpans[spanIndex] = updated;
+			for (int i = spanIndex + 1; delta != 0 && i < (int)funcSpans.size(); i++) {
+				funcSpans[i].firstToken += delta;
+				funcSpans[i].bodyStart += delta;
+				funcSpans[i].endToken += delta;
+			}
+			delete oldSSA;
+			return true;
+		}
+		delete oldSSA;
+	}
+
+	parse();
+	return false;
+}
+
 void Parser::reset() {
 	ssa->reset();
 }
@@ -1079,7 +1128,7 @@ void Parser::printSSA() {
 		//std::cout << std::endl;
 		//ssa->generateLiveRanges();
 		//std::cout << "Basic Block Traversal: " << std::endl;
-		ssa->traverseBasicBlocks(ssa->getBBTail());
+		ssa->computeLiveness();
 		//ssa->printLiveRanges();
 		std::cout << std::endl;
 		ssa->generateIGraphNodes();
@@ -2,8 +2,10 @@
 #define __PARSER_H__
 
 #include <vector>
+#include <string_view>
 #include <unordered_map>
 #include "token.h"
+#include "lexer.h"
 #include "ssa.h"
 
 typedef struct {
@@ -11,13 +13,40 @@ typedef struct {
 	std::vector<std::string> formalParams;
 } funcDescriptor;
 
+// where a funcDecl sits in the token vector
+typedef struct {
+	std::string name;
+	int firstToken;	// 'void' or 'function'
+	int bodyStart;	// first token after the function's name
+	int endToken;	// one past the closing ';'
+} funcSpan;
+
 class Parser {
 	public:
 	//SSAValue Expression();
 	//SSAValue 
 
-		void setTokens(std::vector<Token> inTokens);
+		Parser();
+		~Parser();
+		Parser(const Parser&) = delete;
+		Parser& operator=(const Parser&) = delete;
+		void setTokens(const std::vector<Token>& inTokens, TokenPool* inPool);
+		// streaming mode, tokens are pulled from the lexer as parsing goes
+		void setLexer(Lexer* lex);
+		// streaming mode driven by the lexer's coroutine
+		void setGenerator(Lexer* lex);
+		// incremental mode, reads the lexer's tokens in place so reparse()
+		// sees its edits
+		void setIncremental(Lexer* lex);
+		// after lex.applyEdit(), re-parses only the function declaration
+		// holding the edit and keeps every other SSA. returns false when it
+		// had to fall back to parsing the whole program
+		bool reparse(const tokenEdit& edit);
 		void setDebug(bool debugMode);
+		// objects and arena blocks held by the current program's SSAs
+		void countAllocations(size_t& objects, size_t& blocks);
+		// every function's SSA, in the order printSSA() visits them
+		std::vector<SSA*> getSSAs();
 
 		SSAValue* varRef();
 		std::tuple<SSAValue*, std::string> factor();
@@ -42,6 +71,7 @@ class Parser {
 
 		void parse();
 		std::string outputSSA();
+		std::string outputSSA(const std::string& funcName);
 		void printSSA();
 		void printDotLang();
 		void printRegDotLang();
@@ -49,14 +79,22 @@ class Parser {
 		void reset();
 
 	private:
+		void clearSSAs();
 		bool debug;
 		std::vector<Token> tokens;
+		const std::vector<Token>* tokenList; // tokens, or the lexer's in incremental mode
+		TokenPool* pool; // identifier and number values, owned by the lexer
 		int currPos;
+		bool streaming;
+		TokenCursor cursor;
+		TokenGenerator generator;
 		tokenType sym;
 		int currentPrintIndent;
 		SSA* ssa; // current ssa that is in context
 		std::unordered_map<std::string, SSA*> programSSAs;
 		std::unordered_map<std::string, funcDescriptor> funcDescriptors;
+		std::vector<funcSpan> funcSpans;
+		int errorCount;
 		std::unordered_map<int, SSAValue*>* constTable;
 		BasicBlock* constBlock;
 
@@ -64,12 +102,19 @@ class Parser {
 		SSAValue* joinBlockHead;
 		BasicBlock* joinBlock;
 
-		std::unordered_map<std::string, SSAValue*> phiMap;
+		// variables each finished statSequence assigned. an if or while
+		// reads the entries its bodies added and drops them again, so the
+		// entries of the enclosing bodies stay below untouched
+		std::vector<scopeDef> scopeDefs;
+		// else values by variable id while an if-then-else merges, all null
+		// outside of that
+		std::vector<SSAValue*> elseDefs;
 
 
 		// traversal functions
 		void next();
-		std::string getCurrentValue();
+		const Token& currentToken();
+		std::string_view getCurrentValue(); // view into the lexer's source
 
 	
 		void error(std::string errorMessage);
@@ -82,7 +127,7 @@ class Parser {
 		std::string createIndent();
 		void incPrintInd();
 		void decPrintInd();
-		void printItem(std::string item, std::string value = "");
+		void printItem(std::string item, std::string_view value = "");
 		void startPrintBlock(std::string blockName);
 
 };
@@ -0,0 +1,72 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Hands out objects of one type from blocks that double in size, so a
+// small function doesn't pay for a big block. Objects are never freed one
+// at a time, all of them are destroyed and their blocks released together
+// by clear() or when the pool goes away.
+template <typename T>
+class ArenaPool {
+	public:
+		static constexpr size_t FIRST_BLOCK_OBJECTS = 8;
+		static constexpr size_t MAX_BLOCK_OBJECTS = 1024;
+
+		ArenaPool() {
+			used = 0;
+			count = 0;
+		}
+		~ArenaPool() {
+			clear();
+		}
+		ArenaPool(const ArenaPool&) = delete;
+		ArenaPool& operator=(const ArenaPool&) = delete;
+
+		// T() with no arguments value-initializes, same as new T()
+		template <typename... Args>
+		T* create(Args&&... args) {
+			if (blocks.empty() || used == blockObjects(blocks.size() - 1)) {
+				blocks.push_back(static_cast<T*>(::operator new(sizeof(T) * blockObjects(blocks.size()))));
+				used = 0;
+			}
+			T* obj = new (blocks.back() + used) T(std::forward<Args>(args)...);
+			used += 1;
+			count += 1;
+			return obj;
+		}
+
+		void clear() {
+			for (size_t b = 0; b < blocks.size(); b++) {
+				size_t numObjects = (b + 1 == blocks.size()) ? used : blockObjects(b);
+				for (size_t i = 0; i < numObjects; i++) {
+					blocks[b][i].~T();
+				}
+				::operator delete(blocks[b]);
+			}
+			blocks.clear();
+			used = 0;
+			count = 0;
+		}
+
+		size_t size() const {
+			return count;
+		}
+		size_t blockCount() const {
+			return blocks.size();
+		}
+
+	private:
+		static size_t blockObjects(size_t block) {
+			return block < 7 ? FIRST_BLOCK_OBJECTS << block : MAX_BLOCK_OBJECTS;
+		}
+
+		std::vector<T*> blocks;
+		size_t used;	// objects in the last block
+		size_t count;
+};
+
+#endif
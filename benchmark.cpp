@@ -0,0 +1,1161 @@
+#include "benchmark.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "lexer.h"
+#include "Parser.h"
+
+static const int numBenchVars = 8;
+
+std::string generateProgram(int numLines) {
+	std::stringstream prog;
+	prog << "main" << std::endl;
+	prog << "    var ";
+	for (int i = 0; i < numBenchVars; i++) {
+		prog << "v" << i << (i + 1 < numBenchVars ? ", " : ";\n");
+	}
+	prog << "{" << std::endl;
+	int line = 3;
+	int stmt = 0;
+	while (line < numLines) {
+		std::string a = "v" + std::to_string(stmt % numBenchVars);
+		std::string b = "v" + std::to_string((stmt + 3) % numBenchVars);
+		switch (stmt % 4) {
+			case 0: {
+				prog << "    let " << a << " <- " << b << " * 2 + (" << a << " - " << stmt << ") / 3;" << std::endl;
+				line += 1;
+			} break;
+			case 1: {
+				prog << "    /* statement " << stmt << " */" << std::endl;
+				prog << "    if " << a << " <= " << b << " then" << std::endl;
+				prog << "        let " << a << " <- " << a << " + 1;" << std::endl;
+				prog << "    else" << std::endl;
+				prog << "        let " << b << " <- " << b << " - 1;" << std::endl;
+				prog << "    fi;" << std::endl;
+				line += 6;
+			} break;
+			case 2: {
+				prog << "    while " << a << " != " << b << " do" << std::endl;
+				prog << "        let " << a << " <- " << b << ";" << std::endl;
+				prog << "    od;" << std::endl;
+				line += 3;
+			} break;
+			case 3: {
+				prog << "    call OutputNum(" << a << " + " << b << ");" << std::endl;
+				line += 1;
+			} break;
+		}
+		stmt += 1;
+	}
+	prog << "    call OutputNewLine()" << std::endl;
+	prog << "}." << std::endl;
+	return prog.str();
+}
+
+std::string generateFunctionProgram(int numFunctions) {
+	std::ostringstream out;
+	out << "main" << std::endl;
+	out << "var a, b;" << std::endl;
+	for (int i = 0; i < numFunctions; i++) {
+		out << "function f" << i << "(x, y);" << std::endl;
+		out << "var t, u;" << std::endl;
+		out << "{" << std::endl;
+		out << "\tlet t <- x + y * " << i << ";" << std::endl;
+		out << "\tlet u <- t * 2;" << std::endl;
+		out << "\tif t < u then" << std::endl;
+		out << "\t\tlet t <- t + 1" << std::endl;
+		out << "\telse" << std::endl;
+		out << "\t\tlet u <- u - 1" << std::endl;
+		out << "\tfi;" << std::endl;
+		out << "\treturn t + u" << std::endl;
+		out << "};" << std::endl;
+	}
+	out << "{" << std::endl;
+	out << "\tlet a <- call f0(1, 2);" << std::endl;
+	out << "\tcall OutputNum(a)" << std::endl;
+	out << "}." << std::endl;
+	return out.str();
+}
+
+std::string generateVarsProgram(int numVars, int numStatements) {
+	std::ostringstream out;
+	out << "main" << std::endl;
+	out << "var ";
+	for (int i = 0; i < numVars; i++) {
+		out << "x" << i << (i + 1 < numVars ? ", " : ";\n");
+	}
+	out << "{" << std::endl;
+	std::mt19937 rng(7);
+	// every tenth statement opens an if holding the next few
+	int openIfs = 0;
+	for (int i = 0; i < numStatements; i++) {
+		int a = rng() % numVars;
+		int b = rng() % numVars;
+		int c = rng() % numVars;
+		if (i % 10 == 0) {
+			out << "\tif x" << a << " < x" << b << " then" << std::endl;
+			openIfs += 1;
+		}
+		out << "\tlet x" << a << " <- x" << b << " + x" << c << ";" << std::endl;
+		if (i % 10 == 4) {
+			out << "\tlet x" << c << " <- x" << a << " * 2" << std::endl;
+			out << "\tfi;" << std::endl;
+			openIfs -= 1;
+		}
+	}
+	for (; openIfs > 0; openIfs--) {
+		out << "\tlet x0 <- x0" << std::endl;
+		out << "\tfi;" << std::endl;
+	}
+	out << "\tcall OutputNum(x0)" << std::endl;
+	out << "}." << std::endl;
+	return out.str();
+}
+
+std::string generateLoopProgram(int numLoops) {
+	std::ostringstream out;
+	out << "main" << std::endl;
+	out << "var i, j, k, s, t;" << std::endl;
+	out << "{" << std::endl;
+	out << "\tlet s <- 0;" << std::endl;
+	out << "\tlet t <- 1;" << std::endl;
+	for (int loop = 0; loop < numLoops; loop++) {
+		out << "\tlet i <- 0;" << std::endl;
+		out << "\twhile i < " << (loop % 7 + 3) << " do" << std::endl;
+		out << "\t\tlet s <- s + i * 2;" << std::endl;
+		out << "\t\tlet t <- t + s;" << std::endl;
+		out << "\t\tlet j <- i + 1;" << std::endl;
+		// every other loop has a loop inside
+		if (loop % 2 == 1) {
+			out << "\t\twhile j < 5 do" << std::endl;
+			out << "\t\t\tlet k <- j * 3 - t;" << std::endl;
+			out << "\t\t\tlet j <- j + 1" << std::endl;
+			out << "\t\tod;" << std::endl;
+		}
+		out << "\t\tlet k <- j * 3 - t;" << std::endl;
+		out << "\t\tlet i <- i + 1" << std::endl;
+		out << "\tod;" << std::endl;
+	}
+	out << "\tcall OutputNum(s + t + k)" << std::endl;
+	out << "}." << std::endl;
+	return out.str();
+}
+
+std::string generateNestedLoopProgram(int depth) {
+	std::ostringstream out;
+	out << "main" << std::endl;
+	out << "var s, t";
+	for (int level = 0; level < depth; level++) {
+		out << ", i" << level;
+	}
+	out << ";" << std::endl;
+	out << "{" << std::endl;
+	out << "let s <- 0;" << std::endl;
+	for (int level = 0; level < depth; level++) {
+		out << "let i" << level << " <- 0;" << std::endl;
+		out << "while i" << level << " < 2 do" << std::endl;
+		out << "let s <- s + i" << level << " * 2;" << std::endl;
+		out << "let t <- s - t;" << std::endl;
+	}
+	for (int level = depth - 1; level >= 0; level--) {
+		out << "let i" << level << " <- i" << level << " + 1" << std::endl;
+		out << "od" << (level > 0 ? ";" : "") << std::endl;
+	}
+	out << "}." << std::endl;
+	return out.str();
+}
+
+std::string generateNestedIfProgram(int depth, int numVars) {
+	std::ostringstream out;
+	out << "main" << std::endl;
+	out << "var ";
+	for (int i = 0; i < numVars; i++) {
+		out << "x" << i << (i + 1 < numVars ? ", " : ";\n");
+	}
+	out << "{" << std::endl;
+	for (int i = 0; i < numVars; i++) {
+		out << "let x" << i << " <- " << i << ";" << std::endl;
+	}
+	// every level assigns two variables before opening the next if and
+	// one more in its else, so the phis of a level cover all levels below
+	for (int level = 0; level < depth; level++) {
+		int a = level % numVars;
+		int b = (level * 7 + 3) % numVars;
+		out << "let x" << a << " <- x" << b << " + " << level << ";" << std::endl;
+		out << "let x" << b << " <- x" << a << " * 2;" << std::endl;
+		out << "if x" << a << " < x" << b << " then" << std::endl;
+	}
+	out << "let x0 <- x1" << std::endl;
+	for (int level = depth - 1; level >= 0; level--) {
+		out << "else let x" << (level * 3 + 1) % numVars << " <- x" << level % numVars << " - 1" << std::endl;
+		out << "fi" << (level > 0 ? "" : ";") << std::endl;
+	}
+	out << "call OutputNum(x0)" << std::endl;
+	out << "}." << std::endl;
+	return out.str();
+}
+
+std::string generateStateMachineProgram(int numStates) {
+	std::ostringstream out;
+	out << "main" << std::endl;
+	out << "var s, x, y;" << std::endl;
+	out << "{" << std::endl;
+	out << "let s <- 1;" << std::endl;
+	out << "let x <- 0;" << std::endl;
+	out << "let y <- 0;" << std::endl;
+	out << "while s != 0 do" << std::endl;
+	for (int state = 1; state <= numStates; state++) {
+		int next = state < numStates ? state + 1 : 0;
+		out << "\tif s == " << state << " then" << std::endl;
+		if (state % 3 == 0) {
+			out << "\t\tif x < y then let x <- x + " << state << " else let y <- y + 1 fi;" << std::endl;
+		} else {
+			out << "\t\tlet x <- x + y * " << state << ";" << std::endl;
+		}
+		out << "\t\tlet s <- " << next << std::endl;
+		out << "\tfi" << (state < numStates ? ";" : "") << std::endl;
+	}
+	out << "od;" << std::endl;
+	out << "call OutputNum(x)" << std::endl;
+	out << "}." << std::endl;
+	return out.str();
+}
+
+void writeProgram(std::string fileName, int numLines) {
+	std::ofstream out(fileName);
+	out << generateProgram(numLines);
+}
+
+static long long fileSize(std::string fileName) {
+	std::ifstream in(fileName, std::ios::binary | std::ios::ate);
+	return in.tellg();
+}
+
+double benchmarkLexer(std::string fileName, int iterations, bool mapped) {
+	long long bytes = fileSize(fileName);
+	size_t numTokens = 0;
+	size_t tokenBytes = 0;
+	size_t poolBytes = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		if (mapped) {
+			lex.mapFile(fileName);
+		} else {
+			lex.setFile(fileName);
+		}
+		lex.tokenize();
+		const std::vector<Token>& tokens = lex.getTokens();
+		numTokens = tokens.size();
+		tokenBytes = tokens.capacity() * sizeof(Token);
+		poolBytes = lex.getPool()->memoryUsage();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double mbPerSec = (bytes * (double)iterations) / (1024.0 * 1024.0) / seconds;
+
+	std::cout << (mapped ? "lexer (mapped): " : "lexer (read): ") << bytes << " bytes, " << numTokens << " tokens, "
+		<< iterations << " iterations, " << seconds << " s, " << mbPerSec << " MB/s" << std::endl;
+	std::cout << "  " << sizeof(Token) << " bytes per token, " << tokenBytes << " bytes of tokens, "
+		<< poolBytes << " bytes of token pool" << std::endl;
+	return mbPerSec;
+}
+
+double benchmarkParser(std::string fileName, int iterations, bool streaming) {
+	long long bytes = fileSize(fileName);
+	size_t tokenBytes = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.mapFile(fileName);
+		Parser parser;
+		parser.setDebug(false);
+		if (streaming) {
+			parser.setLexer(&lex);
+			tokenBytes = TokenCursor::LOOKAHEAD * sizeof(Token);
+		} else {
+			lex.tokenize();
+			parser.setTokens(lex.getTokens(), lex.getPool());
+			// the lexer's vector plus the parser's copy of it
+			tokenBytes = (lex.getTokens().capacity() + lex.getTokens().size()) * sizeof(Token);
+		}
+		parser.parse();
+		parser.reset();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double mbPerSec = (bytes * (double)iterations) / (1024.0 * 1024.0) / seconds;
+
+	std::cout << (streaming ? "lex+parse (streaming): " : "lex+parse (batch): ") << bytes << " bytes, "
+		<< iterations << " iterations, " << seconds << " s, " << mbPerSec << " MB/s, "
+		<< tokenBytes << " bytes of tokens held" << std::endl;
+	return mbPerSec;
+}
+
+double benchmarkParallel(std::string fileName, int iterations, int numThreads) {
+	long long bytes = fileSize(fileName);
+	size_t numTokens = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.mapFile(fileName);
+		lex.tokenizeParallel(numThreads);
+		numTokens = lex.getTokens().size();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double mbPerSec = (bytes * (double)iterations) / (1024.0 * 1024.0) / seconds;
+	std::cout << "  " << numThreads << " threads: " << numTokens << " tokens, " << seconds << " s, "
+		<< mbPerSec << " MB/s" << std::endl;
+	return mbPerSec;
+}
+
+void benchmarkInMemory(int numLines, int compilations) {
+	std::string program = generateProgram(numLines);
+	std::string fileName = "bench_request.tiny";
+	double seconds[2];
+	for (int inMemory = 0; inMemory < 2; inMemory++) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < compilations; i++) {
+			Lexer lex;
+			if (inMemory) {
+				lex.setSource(program);
+			} else {
+				// what a service had to do per request before
+				{
+					std::ofstream out(fileName, std::ios::binary);
+					out << program;
+				}
+				lex.mapFile(fileName);
+			}
+			Parser parser;
+			parser.setDebug(false);
+			parser.setLexer(&lex);
+			parser.parse();
+			parser.reset();
+		}
+		auto end = std::chrono::steady_clock::now();
+		seconds[inMemory] = std::chrono::duration<double>(end - start).count();
+	}
+	std::remove(fileName.c_str());
+	std::cout << "in memory: " << compilations << " compilations of " << program.size() << " bytes" << std::endl;
+	std::cout << "  temp file: " << seconds[0] * 1e6 / compilations << " us/compilation" << std::endl;
+	std::cout << "  in memory: " << seconds[1] * 1e6 / compilations << " us/compilation" << std::endl;
+}
+
+// resident set size in kB, -1 where it can't be read
+static long residentKB() {
+	std::ifstream in("/proc/self/status");
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.compare(0, 6, "VmRSS:") == 0) {
+			return std::stol(line.substr(6));
+		}
+	}
+	return -1;
+}
+
+void benchmarkArena(int numFunctions, int compilations) {
+	std::string program = generateFunctionProgram(numFunctions);
+	std::cout << "arena: " << compilations << " compilations of " << program.size() << " bytes" << std::endl;
+	long startKB = residentKB();
+	size_t objects = 0;
+	size_t blocks = 0;
+	// the whole pipeline up to register allocation, its output muted
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < compilations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		lex.tokenize();
+		Parser parser;
+		parser.setDebug(false);
+		parser.setTokens(lex.getTokens(), lex.getPool());
+		parser.parse();
+		parser.printDotLang();
+		parser.printSSA();
+		parser.countAllocations(objects, blocks);
+		parser.reset();
+	}
+	auto end = std::chrono::steady_clock::now();
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	long endKB = residentKB();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << "  " << objects << " objects in " << blocks << " arena blocks per compilation" << std::endl;
+	std::cout << "  " << seconds * 1e6 / compilations << " us/compilation" << std::endl;
+	if (startKB >= 0) {
+		std::cout << "  rss " << startKB << " kB before, " << endKB << " kB after" << std::endl;
+	} else {
+		std::cout << "  rss n/a" << std::endl;
+	}
+}
+
+void benchmarkPasses(int numLines, int iterations) {
+	std::string program = generateProgram(numLines);
+	double livenessSeconds = 0;
+	double coloringSeconds = 0;
+	size_t numValues = 0;
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		lex.tokenize();
+		Parser parser;
+		parser.setDebug(false);
+		parser.setTokens(lex.getTokens(), lex.getPool());
+		parser.parse();
+		parser.printDotLang();
+		// same order as Parser::printSSA()
+		for (SSA* ssa : parser.getSSAs()) {
+			ssa->printSSA();
+			numValues = ssa->getArena().values.size();
+			auto start = std::chrono::steady_clock::now();
+			ssa->computeLiveness();
+			auto mid = std::chrono::steady_clock::now();
+			ssa->generateIGraphNodes();
+			ssa->clusterIGraphNodes();
+			ssa->colorGraph();
+			ssa->generateRegisters();
+			auto end = std::chrono::steady_clock::now();
+			livenessSeconds += std::chrono::duration<double>(mid - start).count();
+			coloringSeconds += std::chrono::duration<double>(end - mid).count();
+		}
+	}
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	std::cout << "passes: " << numLines << " lines, " << numValues << " values, " << iterations << " iterations" << std::endl;
+	std::cout << "  liveness: " << livenessSeconds * 1e3 / iterations << " ms" << std::endl;
+	std::cout << "  coloring: " << coloringSeconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+void benchmarkLiveness(int numLines, int iterations) {
+	std::string program = generateProgram(numLines);
+	double livenessSeconds = 0;
+	int numBlocks = 0;
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		parser.printDotLang();
+		for (SSA* ssa : parser.getSSAs()) {
+			ssa->printSSA();
+			ssa->computeDominators();
+			numBlocks = ssa->getDominators().size();
+			auto start = std::chrono::steady_clock::now();
+			ssa->computeLiveness();
+			auto end = std::chrono::steady_clock::now();
+			livenessSeconds += std::chrono::duration<double>(end - start).count();
+		}
+	}
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	std::cout << "liveness: " << numLines << " lines, " << numBlocks << " blocks, " << iterations << " iterations" << std::endl;
+	std::cout << "  computeLiveness: " << livenessSeconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+// every interference edge as value ids, to check the kernels agree
+static std::vector<std::pair<int, int>> interferenceEdges(SSA* ssa) {
+	const InterferenceGraph& graph = ssa->getInterference();
+	std::vector<std::pair<int, int>> edges;
+	for (int node = 0; node < graph.size(); node++) {
+		for (int other : graph.neighbors(node)) {
+			edges.push_back({ graph.values[node]->id, graph.values[other]->id });
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	return edges;
+}
+
+void benchmarkBitset(int numLines, int iterations) {
+	std::cout << "bitset: cpu supports " << getBitsetKernels(detectScanLevel()).name << std::endl;
+
+	// the union kernel alone on sets of a million bits
+	size_t numWords = 1 << 14;
+	std::mt19937_64 rng(7);
+	std::vector<uint64_t> src(numWords);
+	std::vector<uint64_t> start(numWords);
+	for (size_t w = 0; w < numWords; w++) {
+		src[w] = rng() & rng();
+		start[w] = rng() & rng();
+	}
+	std::vector<uint64_t> expected;
+	int unions = iterations * 1000;
+	for (int level = SCAN_SCALAR; level <= detectScanLevel(); level++) {
+		const bitsetKernels& kernels = getBitsetKernels((scanLevel)level);
+		std::vector<uint64_t> dst(start);
+		size_t changed = 0;
+		auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < unions; i++) {
+			// alternating halves so every union has something to add
+			size_t half = numWords / 2;
+			changed += kernels.unionWith(dst.data() + (i % 2) * half, src.data() + (i % 2) * half, half);
+			if (i % 64 == 63) {
+				dst = start;
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		if (level == SCAN_SCALAR) {
+			expected = dst;
+		}
+		double seconds = std::chrono::duration<double>(end - begin).count();
+		std::cout << "  union " << kernels.name << ": " << (unions * (numWords / 2) * 8.0) / (1024.0 * 1024.0 * 1024.0) / seconds
+			<< " GB/s" << (dst == expected ? "" : " MISMATCH") << " (" << changed << " changed)" << std::endl;
+	}
+
+	// liveness of one generated function at every level
+	std::string program = generateProgram(numLines);
+	Lexer lex;
+	lex.setSource(program);
+	Parser parser;
+	parser.setDebug(false);
+	parser.setLexer(&lex);
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	parser.parse();
+	parser.printDotLang();
+	for (SSA* ssa : parser.getSSAs()) {
+		ssa->printSSA();
+	}
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	std::cout << "bitset: liveness, " << numLines << " lines" << std::endl;
+	for (SSA* ssa : parser.getSSAs()) {
+		std::vector<std::pair<int, int>> expectedEdges;
+		for (int level = SCAN_SCALAR; level <= detectScanLevel(); level++) {
+			ssa->setBitsetLevel((scanLevel)level);
+			auto begin = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++) {
+				ssa->computeLiveness();
+			}
+			auto end = std::chrono::steady_clock::now();
+			std::vector<std::pair<int, int>> edges = interferenceEdges(ssa);
+			if (level == SCAN_SCALAR) {
+				expectedEdges = edges;
+			}
+			std::cout << "  " << getBitsetKernels((scanLevel)level).name << ": "
+				<< std::chrono::duration<double>(end - begin).count() * 1e3 / iterations << " ms, " << edges.size() << " edges"
+				<< (edges == expectedEdges ? "" : " MISMATCH") << std::endl;
+		}
+	}
+}
+
+void benchmarkInterference(int numLines, int iterations) {
+	std::string program = generateProgram(numLines);
+	double livenessSeconds = 0;
+	double nodesSeconds = 0;
+	int numNodes = 0;
+	int numEdges = 0;
+	bool matrix = false;
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		parser.printDotLang();
+		for (SSA* ssa : parser.getSSAs()) {
+			ssa->printSSA();
+			auto start = std::chrono::steady_clock::now();
+			ssa->computeLiveness();
+			auto mid = std::chrono::steady_clock::now();
+			ssa->generateIGraphNodes();
+			auto end = std::chrono::steady_clock::now();
+			livenessSeconds += std::chrono::duration<double>(mid - start).count();
+			nodesSeconds += std::chrono::duration<double>(end - mid).count();
+			numNodes = ssa->getInterference().size();
+			numEdges = ssa->getInterference().numEdges();
+			matrix = ssa->getInterference().usesMatrix();
+		}
+	}
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	std::cout << "interference: " << numLines << " lines, " << numNodes << " nodes, " << numEdges << " edges, "
+		<< (matrix ? "bit matrix" : "edge hash") << ", " << iterations << " iterations" << std::endl;
+	std::cout << "  computeLiveness: " << livenessSeconds * 1e3 / iterations << " ms" << std::endl;
+	std::cout << "  generateIGraphNodes: " << nodesSeconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+void benchmarkColoring(int numLines, int iterations) {
+	std::string program = generateProgram(numLines);
+	double coalesceSeconds = 0;
+	double coloringSeconds = 0;
+	int numNodes = 0;
+	int numColors = 0;
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		parser.printDotLang();
+		for (SSA* ssa : parser.getSSAs()) {
+			ssa->printSSA();
+			ssa->computeLiveness();
+			ssa->generateIGraphNodes();
+			auto start = std::chrono::steady_clock::now();
+			ssa->clusterIGraphNodes();
+			auto mid = std::chrono::steady_clock::now();
+			ssa->colorGraph();
+			auto end = std::chrono::steady_clock::now();
+			coalesceSeconds += std::chrono::duration<double>(mid - start).count();
+			coloringSeconds += std::chrono::duration<double>(end - mid).count();
+			ssa->generateRegisters();
+			ssa->setRegisters();
+			const InterferenceGraph& graph = ssa->getInterference();
+			numNodes = graph.size();
+			numColors = 0;
+			for (SSAValue* value : graph.values) {
+				numColors = std::max(numColors, value->info->regNum);
+			}
+		}
+	}
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	std::cout << "coloring: " << numLines << " lines, " << numNodes << " nodes, " << numColors << " colors, "
+		<< iterations << " iterations" << std::endl;
+	std::cout << "  clusterIGraphNodes: " << coalesceSeconds * 1e3 / iterations << " ms" << std::endl;
+	std::cout << "  colorGraph: " << coloringSeconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+void benchmarkFixup(int numStates, int iterations) {
+	std::string program = generateStateMachineProgram(numStates);
+	double fixupSeconds = 0;
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		for (SSA* ssa : parser.getSSAs()) {
+			auto start = std::chrono::steady_clock::now();
+			ssa->correctBasicBlockIssues();
+			auto end = std::chrono::steady_clock::now();
+			fixupSeconds += std::chrono::duration<double>(end - start).count();
+		}
+	}
+	std::cout << "fixup: " << numStates << " states, " << iterations << " iterations" << std::endl;
+	std::cout << "  correctBasicBlockIssues: " << fixupSeconds * 1e3 / iterations << " ms" << std::endl;
+
+	// the same number of blocks again, each falling through two blocks
+	// ahead so every one of them has to be fixed up
+	int numBlocks = numStates * 4;
+	fixupSeconds = 0;
+	for (int i = 0; i < iterations; i++) {
+		SSA ssa("fixup");
+		std::vector<BasicBlock*> blocks;
+		blocks.push_back(ssa.getBBListHead());
+		for (int b = 1; b < numBlocks; b++) {
+			blocks.push_back(ssa.createContext());
+		}
+		for (int b = 0; b + 2 < numBlocks; b++) {
+			ssa.connectFT(blocks[b], blocks[b + 2]);
+		}
+		auto start = std::chrono::steady_clock::now();
+		ssa.correctBasicBlockIssues();
+		auto end = std::chrono::steady_clock::now();
+		fixupSeconds += std::chrono::duration<double>(end - start).count();
+	}
+	std::cout << "fixup: " << numBlocks << " blocks falling through to the wrong block" << std::endl;
+	std::cout << "  correctBasicBlockIssues: " << fixupSeconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+void benchmarkSymbols(int numVars, int iterations) {
+	std::string program = generateVarsProgram(numVars, numVars * 4);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		parser.reset();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << "symbols: " << numVars << " variables, " << numVars * 4 << " statements, " << program.size() << " bytes" << std::endl;
+	std::cout << "  lex+parse: " << seconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+void benchmarkLoops(int numLoops, int iterations) {
+	std::string program = generateLoopProgram(numLoops);
+	double parseSeconds = 0;
+	double totalSeconds = 0;
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	for (int i = 0; i < iterations; i++) {
+		auto start = std::chrono::steady_clock::now();
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		auto parsed = std::chrono::steady_clock::now();
+		parser.printDotLang();
+		parser.printSSA();
+		parser.reset();
+		auto end = std::chrono::steady_clock::now();
+		parseSeconds += std::chrono::duration<double>(parsed - start).count();
+		totalSeconds += std::chrono::duration<double>(end - start).count();
+	}
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	std::cout << "loops: " << numLoops << " while loops, " << program.size() << " bytes" << std::endl;
+	std::cout << "  lex+parse: " << parseSeconds * 1e3 / iterations << " ms" << std::endl;
+	std::cout << "  full compile: " << totalSeconds * 1e3 / iterations << " ms" << std::endl;
+
+	// the same number of loops nested inside each other, parsing only
+	program = generateNestedLoopProgram(numLoops);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		parser.reset();
+	}
+	auto end = std::chrono::steady_clock::now();
+	std::cout << "loops: " << numLoops << " nested while loops, " << program.size() << " bytes" << std::endl;
+	std::cout << "  lex+parse: " << std::chrono::duration<double>(end - start).count() * 1e3 / iterations << " ms" << std::endl;
+}
+
+// a chain of numBlocks blocks where some blocks also branch a little way
+// ahead, like an if, or loop a little way back, like a while. the back
+// edges can enter the middle of a forward branch, so not every cycle has a
+// single header
+static void randomCFG(std::vector<BasicBlock>& storage, int numBlocks, std::vector<BasicBlock*>& cfg) {
+	std::mt19937 rng(18);
+	storage.assign(numBlocks, BasicBlock());
+	cfg.clear();
+	for (int b = 0; b < numBlocks; b++) {
+		storage[b].id = b;
+		cfg.push_back(&storage[b]);
+	}
+	for (int b = 0; b + 1 < numBlocks; b++) {
+		storage[b].succ[EDGE_FT] = &storage[b + 1];
+		int kind = rng() % 8;
+		if (kind < 2) {
+			storage[b].succ[EDGE_BR] = &storage[std::min(numBlocks - 1, b + 2 + (int)(rng() % 16))];
+		} else if (kind == 2) {
+			storage[b].succ[EDGE_LOOP] = &storage[std::max(0, b - 1 - (int)(rng() % 16))];
+		}
+	}
+}
+
+static void reportDominators(const DominatorTree& dom, double seconds, int iterations) {
+	int reachable = 0;
+	int depth = 0;
+	std::vector<int> treeDepth(dom.size(), 0);
+	for (int b : dom.rpo) {
+		reachable++;
+		if (dom.idom[b] >= 0) {
+			treeDepth[b] = treeDepth[dom.idom[b]] + 1;
+			depth = std::max(depth, treeDepth[b]);
+		}
+	}
+	std::cout << "  " << reachable << " reachable, dominator tree depth " << depth << ", " << dom.frontier.size() << " frontier entries, " << dom.iterations << " passes" << std::endl;
+	std::cout << "  dominators: " << seconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+void benchmarkDominators(int numBlocks, int iterations) {
+	// the biggest function of a generated program, about 5 blocks every 11 lines
+	std::string program = generateProgram(numBlocks * 11 / 5);
+	Lexer lex;
+	lex.setSource(program);
+	Parser parser;
+	parser.setDebug(false);
+	parser.setLexer(&lex);
+	parser.parse();
+	SSA* largest = nullptr;
+	for (SSA* ssa : parser.getSSAs()) {
+		ssa->computeDominators();
+		if (largest == nullptr || ssa->getDominators().size() > largest->getDominators().size()) {
+			largest = ssa;
+		}
+	}
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		largest->computeDominators();
+	}
+	auto end = std::chrono::steady_clock::now();
+	std::cout << "dominators: parsed program, " << largest->getDominators().size() << " blocks" << std::endl;
+	reportDominators(largest->getDominators(), std::chrono::duration<double>(end - start).count(), iterations);
+
+	std::vector<BasicBlock> storage;
+	std::vector<BasicBlock*> cfg;
+	randomCFG(storage, numBlocks, cfg);
+	DominatorTree dom;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		dom.compute(cfg, cfg[0]);
+	}
+	end = std::chrono::steady_clock::now();
+	std::cout << "dominators: random cfg, " << numBlocks << " blocks" << std::endl;
+	reportDominators(dom, std::chrono::duration<double>(end - start).count(), iterations);
+}
+
+void benchmarkNestedIfs(int depth, int iterations) {
+	std::string program = generateNestedIfProgram(depth, 64);
+	int instructions = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		Parser parser;
+		parser.setDebug(false);
+		parser.setLexer(&lex);
+		parser.parse();
+		instructions = parser.getSSAs()[0]->getTailID();
+		parser.reset();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << "nested: " << depth << " nested ifs, " << program.size() << " bytes, " << instructions << " instructions" << std::endl;
+	std::cout << "  lex+parse: " << seconds * 1e3 / iterations << " ms" << std::endl;
+}
+
+void benchmarkIncremental(int numFunctions, int edits) {
+	std::string program = generateFunctionProgram(numFunctions);
+
+	// full recompile of the source, what every keystroke used to cost
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < edits; i++) {
+		Lexer lex;
+		lex.setSource(program);
+		lex.tokenize();
+		Parser parser;
+		parser.setTokens(lex.getTokens(), lex.getPool());
+		parser.parse();
+	}
+	auto mid = std::chrono::steady_clock::now();
+
+	// the same program edited in place, a constant inside of the middle
+	// function flips between two values
+	Lexer lex;
+	lex.setIncrementalSource(program);
+	Parser parser;
+	parser.setIncremental(&lex);
+	parser.parse();
+	std::string marker = "y * " + std::to_string(numFunctions / 2) + ";";
+	size_t offset = program.find(marker) + 4;
+	size_t length = std::to_string(numFunctions / 2).size();
+	int partial = 0;
+	auto incStart = std::chrono::steady_clock::now();
+	for (int i = 0; i < edits; i++) {
+		std::string value = std::to_string((i % 2) ? numFunctions / 2 : numFunctions / 2 + 1);
+		tokenEdit edit = lex.applyEdit(offset, length, value);
+		length = value.size();
+		if (parser.reparse(edit)) {
+			partial += 1;
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double fullUs = std::chrono::duration<double, std::micro>(mid - start).count() / edits;
+	double incUs = std::chrono::duration<double, std::micro>(end - incStart).count() / edits;
+	std::cout << "incremental: " << numFunctions << " functions, " << program.size() << " bytes, " << edits << " edits" << std::endl;
+	std::cout << "  full recompile: " << fullUs << " us/edit" << std::endl;
+	std::cout << "  incremental:    " << incUs << " us/edit (" << partial << " partial reparses)" << std::endl;
+}
+
+double benchmarkScan(std::string fileName, int iterations, scanLevel level) {
+	long long bytes = fileSize(fileName);
+	size_t numTokens = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		Lexer lex;
+		lex.setScanLevel(level);
+		lex.mapFile(fileName);
+		lex.tokenize();
+		numTokens = lex.getTokens().size();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	double mbPerSec = (bytes * (double)iterations) / (1024.0 * 1024.0) / seconds;
+	std::cout << "  " << getScanKernels(level).name << ": " << numTokens << " tokens, " << seconds << " s, "
+		<< mbPerSec << " MB/s" << std::endl;
+	return mbPerSec;
+}
+
+static const char* corpusFiles[] = { "tests/test1.tiny", "tests/test2.tiny", "tests/test3.tiny", "tests/test4.tiny",
+	"tests/test5.tiny", "tests/test6.tiny", "tests/test7.tiny", "tests/testSSA.tiny" };
+static const int numCorpusFiles = sizeof(corpusFiles) / sizeof(corpusFiles[0]);
+
+enum tokenSource { FROM_VECTOR, FROM_CURSOR, FROM_COROUTINE };
+static const char* tokenSourceNames[] = { "vector", "cursor", "coroutine" };
+
+void benchmarkCoroutine(int scale) {
+	// lexing alone over the whole corpus repeated scale times
+	std::string corpus;
+	for (int i = 0; i < numCorpusFiles; i++) {
+		std::ifstream in(corpusFiles[i]);
+		std::stringstream buffer;
+		buffer << in.rdbuf();
+		corpus += buffer.str();
+		corpus += "\n";
+	}
+	std::string fileName = "bench_input.tiny";
+	{
+		std::ofstream out(fileName);
+		for (int i = 0; i < scale; i++) {
+			out << corpus;
+		}
+	}
+	long long bytes = fileSize(fileName);
+	std::cout << "coroutine: tests/ corpus x" << scale << ", " << bytes << " bytes" << std::endl;
+
+	for (int src = FROM_VECTOR; src <= FROM_COROUTINE; src++) {
+		long long typeSum = 0;
+		size_t numTokens = 0;
+		auto start = std::chrono::steady_clock::now();
+		Lexer lex;
+		lex.mapFile(fileName);
+		if (src == FROM_VECTOR) {
+			lex.tokenize();
+			for (const Token& token : lex.getTokens()) {
+				typeSum += token.getType();
+			}
+			numTokens = lex.getTokens().size();
+		} else if (src == FROM_CURSOR) {
+			TokenCursor cursor;
+			cursor.setLexer(&lex);
+			while (!cursor.atEnd()) {
+				typeSum += cursor.current().getType();
+				numTokens += 1;
+				cursor.advance();
+			}
+			typeSum += cursor.current().getType();
+			numTokens += 1;
+		} else {
+			TokenGenerator gen = lex.generateTokens();
+			while (gen.next()) {
+				typeSum += gen.value().getType();
+				numTokens += 1;
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(end - start).count();
+		std::cout << "  lex " << tokenSourceNames[src] << ": " << numTokens << " tokens, " << seconds << " s, "
+			<< (bytes / (1024.0 * 1024.0) / seconds) << " MB/s (checksum " << typeSum << ")" << std::endl;
+	}
+	std::remove(fileName.c_str());
+
+	// lexing and parsing, every corpus program compiled scale times. the
+	// parser doesn't support everything in tests/ yet, its errors are muted
+	std::streambuf* coutBuf = std::cout.rdbuf(nullptr);
+	double parseSeconds[3];
+	for (int src = FROM_VECTOR; src <= FROM_COROUTINE; src++) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < scale; i++) {
+			for (int f = 0; f < numCorpusFiles; f++) {
+				Lexer lex;
+				lex.mapFile(corpusFiles[f]);
+				Parser parser;
+				parser.setDebug(false);
+				if (src == FROM_VECTOR) {
+					lex.tokenize();
+					parser.setTokens(lex.getTokens(), lex.getPool());
+				} else if (src == FROM_CURSOR) {
+					parser.setLexer(&lex);
+				} else {
+					parser.setGenerator(&lex);
+				}
+				parser.parse();
+				parser.reset();
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		parseSeconds[src] = std::chrono::duration<double>(end - start).count();
+	}
+	std::cout.rdbuf(coutBuf);
+	std::cout.clear();
+	for (int src = FROM_VECTOR; src <= FROM_COROUTINE; src++) {
+		std::cout << "  lex+parse " << tokenSourceNames[src] << ": " << (scale * numCorpusFiles) << " programs, "
+			<< parseSeconds[src] << " s" << std::endl;
+	}
+}
+
+// keyword lookup as it was before the perfect hash, kept for comparison
+static int linearIsKeyword(std::string accumulator) {
+	std::string keywords[14] = {
+		"let",
+		"var",
+		"if",
+		"then",
+		"else",
+		"fi",
+		"while",
+		"do",
+		"od",
+		"void",
+		"function",
+		"call",
+		"return",
+		"main"
+	};
+	for (int i = 0; i < 14; ++i) {
+		if (accumulator.compare(keywords[i]) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void benchmarkKeywords(int numWords, int iterations) {
+	// identifier heavy input: keywords, near misses and plain identifiers
+	const char* seeds[] = { "let", "var", "if", "then", "else", "fi", "while", "do", "od",
+		"void", "function", "call", "return", "main", "lets", "ifx", "mains", "d0", "x",
+		"alpha", "counter", "tmp1", "retval", "functions", "calls", "v12" };
+	std::mt19937 rng(42);
+	std::vector<std::string> words;
+	for (int i = 0; i < numWords; i++) {
+		std::string word = seeds[rng() % (sizeof(seeds) / sizeof(seeds[0]))];
+		if (rng() % 4 == 0) {
+			word += std::to_string(rng() % 100);
+		}
+		words.push_back(word);
+	}
+
+	long long linearSum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		for (const std::string& word : words) {
+			linearSum += linearIsKeyword(word);
+		}
+	}
+	auto mid = std::chrono::steady_clock::now();
+	long long hashSum = 0;
+	for (int i = 0; i < iterations; i++) {
+		for (const std::string& word : words) {
+			hashSum += Lexer::isKeyword(word);
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double lookups = (double)numWords * iterations;
+	double linearNs = std::chrono::duration<double, std::nano>(mid - start).count() / lookups;
+	double hashNs = std::chrono::duration<double, std::nano>(end - mid).count() / lookups;
+	std::cout << "keywords: " << numWords << " words, " << iterations << " iterations" << std::endl;
+	std::cout << "  linear compare: " << linearNs << " ns/lookup" << std::endl;
+	std::cout << "  perfect hash:   " << hashNs << " ns/lookup" << std::endl;
+	if (linearSum != hashSum) {
+		std::cout << "  MISMATCH between linear and hashed lookup" << std::endl;
+	}
+}
+
+void runBenchmarks(int argc, char* argv[]) {
+	std::string name = argc > 0 ? argv[0] : "lexer";
+	int size = argc > 1 ? std::stoi(argv[1]) : 50000;
+	int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+	// file based benchmarks run on a generated program with size lines
+	std::string fileName = "bench_input.tiny";
+
+	if (name == "lexer") {
+		writeProgram(fileName, size);
+		benchmarkLexer(fileName, iterations, false);
+		benchmarkLexer(fileName, iterations, true);
+		std::remove(fileName.c_str());
+	} else if (name == "parser") {
+		writeProgram(fileName, size);
+		benchmarkParser(fileName, iterations, false);
+		benchmarkParser(fileName, iterations, true);
+		std::remove(fileName.c_str());
+	} else if (name == "coroutine") {
+		// size is the scale factor here, run from the repository root
+		benchmarkCoroutine(argc > 1 ? size : 1000);
+	} else if (name == "scan") {
+		std::string program = generateProgram(size);
+		std::cout << "scan: generated program, cpu supports " << getScanKernels(detectScanLevel()).name << std::endl;
+		{
+			std::ofstream out(fileName);
+			out << program;
+		}
+		for (int level = SCAN_SCALAR; level <= detectScanLevel(); level++) {
+			benchmarkScan(fileName, iterations, (scanLevel)level);
+		}
+		// same program with indentation, long names and a comment line before every line
+		std::cout << "scan: indented and commented" << std::endl;
+		{
+			std::ofstream out(fileName);
+			std::istringstream in(program);
+			std::string line;
+			while (std::getline(in, line)) {
+				out << "        /* " << std::string(64, '-') << " */\n";
+				out << "                " << line << "\n";
+			}
+		}
+		for (int level = SCAN_SCALAR; level <= detectScanLevel(); level++) {
+			benchmarkScan(fileName, iterations, (scanLevel)level);
+		}
+		std::remove(fileName.c_str());
+	} else if (name == "parallel") {
+		writeProgram(fileName, size);
+		int cores = Lexer::hardwareThreads();
+		std::cout << "parallel: " << fileSize(fileName) << " bytes, " << cores << " hardware threads" << std::endl;
+		double single = 0;
+		for (int threads = 1; threads <= std::max(cores, 4); threads *= 2) {
+			double mbPerSec = benchmarkParallel(fileName, iterations, threads);
+			if (threads == 1) {
+				single = mbPerSec;
+			} else {
+				std::cout << "    speedup " << (mbPerSec / single) << "x" << std::endl;
+			}
+		}
+		std::remove(fileName.c_str());
+	} else if (name == "memory") {
+		benchmarkInMemory(argc > 1 ? size : 20, argc > 2 ? iterations : 10000);
+	} else if (name == "arena") {
+		// size is the number of functions in the program
+		benchmarkArena(argc > 1 ? size : 10, argc > 2 ? iterations : 10000);
+	} else if (name == "passes") {
+		benchmarkPasses(argc > 1 ? size : 400, argc > 2 ? iterations : 20);
+	} else if (name == "liveness") {
+		benchmarkLiveness(argc > 1 ? size : 20000, argc > 2 ? iterations : 10);
+	} else if (name == "bitset") {
+		benchmarkBitset(argc > 1 ? size : 20000, argc > 2 ? iterations : 10);
+	} else if (name == "interference") {
+		benchmarkInterference(argc > 1 ? size : 20000, argc > 2 ? iterations : 10);
+	} else if (name == "coloring") {
+		benchmarkColoring(argc > 1 ? size : 20000, argc > 2 ? iterations : 10);
+	} else if (name == "fixup") {
+		// size is the number of states
+		benchmarkFixup(argc > 1 ? size : 5000, argc > 2 ? iterations : 10);
+	} else if (name == "symbols") {
+		// size is the number of variables
+		benchmarkSymbols(argc > 1 ? size : 5000, iterations);
+	} else if (name == "loops") {
+		// size is the number of while loops
+		benchmarkLoops(argc > 1 ? size : 50, iterations);
+	} else if (name == "nested") {
+		// size is how deep the ifs are nested
+		benchmarkNestedIfs(argc > 1 ? size : 200, argc > 2 ? iterations : 20);
+	} else if (name == "dominators") {
+		// size is the number of blocks
+		benchmarkDominators(argc > 1 ? size : 100000, argc > 2 ? iterations : 10);
+	} else if (name == "incremental") {
+		// size is the number of functions
+		benchmarkIncremental(argc > 1 ? size : 2000, argc > 2 ? iterations : 20);
+	} else if (name == "keywords") {
+		benchmarkKeywords(size, iterations);
+	} else {
+		std::cout << "Unknown benchmark: " << name << std::endl;
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <string>
+#include "scan.h"
+
+// generates a syntactically valid tiny program with roughly numLines lines
+std::string generateProgram(int numLines);
+void writeProgram(std::string fileName, int numLines);
+// numVars variables read and assigned at random, some of it inside ifs
+std::string generateVarsProgram(int numVars, int numStatements);
+// numLoops while loops in a row, every other one with a loop inside it
+std::string generateLoopProgram(int numLoops);
+// while loops nested depth deep
+std::string generateNestedLoopProgram(int depth);
+// ifs nested depth deep, each level assigning some of numVars variables
+std::string generateNestedIfProgram(int depth, int numVars);
+// a while loop around numStates ifs on a state variable, some with an if inside
+std::string generateStateMachineProgram(int numStates);
+// numFunctions small function declarations and a main that calls one
+std::string generateFunctionProgram(int numFunctions);
+
+double benchmarkLexer(std::string fileName, int iterations, bool mapped = false);
+// lexing and parsing, with all tokens up front or pulled through a TokenCursor
+double benchmarkParser(std::string fileName, int iterations, bool streaming);
+// lexer split over numThreads threads
+double benchmarkParallel(std::string fileName, int iterations, int numThreads);
+// lexing and parsing small requests from a temp file and from memory
+void benchmarkInMemory(int numLines, int compilations);
+// full pipeline compiled over and over, arena use and rss at the end
+void benchmarkArena(int numFunctions, int compilations);
+// liveness (computeLiveness) and coloring (interference graph through
+// generateRegisters) on one generated function
+void benchmarkPasses(int numLines, int iterations);
+// liveness alone (computeLiveness) on one big generated function
+void benchmarkLiveness(int numLines, int iterations);
+// union kernel throughput and liveness at every bitset level the cpu has
+void benchmarkBitset(int numLines, int iterations);
+// building the interference graph (computeLiveness) and its nodes
+// (generateIGraphNodes) on one generated function
+void benchmarkInterference(int numLines, int iterations);
+// phi coalescing (clusterIGraphNodes) and simplify/select (colorGraph) on
+// the interference graph of one generated function
+void benchmarkColoring(int numLines, int iterations);
+// cfg fixup (correctBasicBlockIssues) on a generated state machine
+void benchmarkFixup(int numStates, int iterations);
+// parsing a program with numVars variables
+void benchmarkSymbols(int numVars, int iterations);
+// parsing and the full pipeline on a program made of while loops, then
+// parsing numLoops loops nested inside each other
+void benchmarkLoops(int numLoops, int iterations);
+// parsing ifs nested depth deep
+void benchmarkNestedIfs(int depth, int iterations);
+// dominator trees of the largest function in a generated program and of a
+// random cfg, both with about numBlocks blocks
+void benchmarkDominators(int numBlocks, int iterations);
+// full recompiles against Lexer::applyEdit() and Parser::reparse()
+void benchmarkIncremental(int numFunctions, int edits);
+// lexer with a given level of scanning kernels
+double benchmarkScan(std::string fileName, int iterations, scanLevel level);
+// vector, cursor and coroutine token sources over the tests/ corpus repeated scale times
+void benchmarkCoroutine(int scale);
+void benchmarkKeywords(int numWords, int iterations);
+
+// entry point for "tinyCompiler --bench <name> [args]"
+void runBenchmarks(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,137 @@
+#include "bitset.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BITSET_X86
+#include <immintrin.h>
+#endif
+
+// gcc and clang only emit avx2 instructions in functions marked for it,
+// msvc allows the intrinsics anywhere
+#if defined(BITSET_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BITSET_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BITSET_TARGET_AVX2
+#endif
+
+// start scalar kernels
+
+static bool unionWithScalar(uint64_t* dst, const uint64_t* src, size_t n) {
+	uint64_t gained = 0;
+	for (size_t i = 0; i < n; i++) {
+		gained |= src[i] & ~dst[i];
+		dst[i] |= src[i];
+	}
+	return gained != 0;
+}
+
+#ifdef BITSET_X86
+
+// start sse2 kernels, 2 words at a time
+
+static bool unionWithSSE2(uint64_t* dst, const uint64_t* src, size_t n) {
+	size_t i = 0;
+	__m128i gained = _mm_setzero_si128();
+	for (; i + 2 <= n; i += 2) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		gained = _mm_or_si128(gained, _mm_andnot_si128(d, s));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(d, s));
+	}
+	// no ptest before sse4.1, compare against zero instead
+	bool changed = _mm_movemask_epi8(_mm_cmpeq_epi8(gained, _mm_setzero_si128())) != 0xFFFF;
+	bool tail = unionWithScalar(dst + i, src + i, n - i);
+	return changed || tail;
+}
+
+// start avx2 kernels, 4 words at a time
+
+BITSET_TARGET_AVX2 static bool unionWithAVX2(uint64_t* dst, const uint64_t* src, size_t n) {
+	size_t i = 0;
+	__m256i gained = _mm256_setzero_si256();
+	for (; i + 4 <= n; i += 4) {
+		__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+		__m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		gained = _mm256_or_si256(gained, _mm256_andnot_si256(d, s));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(d, s));
+	}
+	bool changed = !_mm256_testz_si256(gained, gained);
+	bool tail = unionWithScalar(dst + i, src + i, n - i);
+	return changed || tail;
+}
+
+#endif
+
+static const bitsetKernels kernelTable[] = {
+	{ SCAN_SCALAR, "scalar", unionWithScalar },
+#ifdef BITSET_X86
+	{ SCAN_SSE2, "sse2", unionWithSSE2 },
+	{ SCAN_AVX2, "avx2", unionWithAVX2 },
+#endif
+};
+
+const bitsetKernels& getBitsetKernels(scanLevel level) {
+	if (level > detectScanLevel()) {
+		level = detectScanLevel();
+	}
+	return kernelTable[level];
+}
+
+// start bitset
+
+BitSet::BitSet() {
+	numBits = 0;
+}
+
+BitSet::BitSet(size_t numBits) {
+	resize(numBits);
+}
+
+void BitSet::resize(size_t numBits) {
+	this->numBits = numBits;
+	words.assign(bitsetWords(numBits), 0);
+}
+
+void BitSet::clear() {
+	std::fill(words.begin(), words.end(), 0);
+}
+
+size_t BitSet::size() const {
+	return numBits;
+}
+
+size_t BitSet::numWords() const {
+	return words.size();
+}
+
+size_t BitSet::count() const {
+	size_t total = 0;
+	for (uint64_t word : words) {
+		total += std::popcount(word);
+	}
+	return total;
+}
+
+bool BitSet::test(size_t bit) const {
+	return testBit(words.data(), bit);
+}
+
+void BitSet::set(size_t bit) {
+	setBit(words.data(), bit);
+}
+
+void BitSet::reset(size_t bit) {
+	clearBit(words.data(), bit);
+}
+
+bool BitSet::unionWith(const BitSet& other, const bitsetKernels& kernels) {
+	return kernels.unionWith(words.data(), other.words.data(), std::min(words.size(), other.words.size()));
+}
+
+uint64_t* BitSet::data() {
+	return words.data();
+}
+
+const uint64_t* BitSet::data() const {
+	return words.data();
+}
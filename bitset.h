@@ -0,0 +1,86 @@
+#ifndef __BITSET_H__
+#define __BITSET_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bit>
+
+#include "scan.h"
+
+// Word parallel kernels over arrays of 64 bit words, the inner loops of
+// liveness and interference. The levels and cpu detection are the same as
+// for the byte scanning kernels, every level gives the same bits.
+struct bitsetKernels {
+	scanLevel level;
+	const char* name;
+	bool (*unionWith)(uint64_t* dst, const uint64_t* src, size_t n);	// dst |= src, true if dst gained a bit
+};
+
+// kernels for level, falls back to a lower level the cpu supports
+const bitsetKernels& getBitsetKernels(scanLevel level);
+
+static const size_t BITSET_WORD_BITS = 64;
+
+static inline size_t bitsetWords(size_t numBits) {
+	return (numBits + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+}
+
+static inline bool testBit(const uint64_t* words, size_t bit) {
+	return (words[bit / BITSET_WORD_BITS] >> (bit % BITSET_WORD_BITS)) & 1;
+}
+
+static inline void setBit(uint64_t* words, size_t bit) {
+	words[bit / BITSET_WORD_BITS] |= (uint64_t)1 << (bit % BITSET_WORD_BITS);
+}
+
+static inline void clearBit(uint64_t* words, size_t bit) {
+	words[bit / BITSET_WORD_BITS] &= ~((uint64_t)1 << (bit % BITSET_WORD_BITS));
+}
+
+// calls f with the index of every set bit in words [first, end)
+template <typename F>
+static inline void forEachBit(const uint64_t* words, size_t first, size_t end, F f) {
+	for (size_t w = first; w < end; w++) {
+		uint64_t word = words[w];
+		while (word != 0) {
+			f(w * BITSET_WORD_BITS + std::countr_zero(word));
+			word &= word - 1;
+		}
+	}
+}
+
+// a set of small ints with a fixed number of bits. bigger users keep many
+// sets of the same width in one array and call the helpers above on rows
+class BitSet {
+	public:
+		BitSet();
+		explicit BitSet(size_t numBits);
+
+		// resizing clears every bit
+		void resize(size_t numBits);
+		void clear();
+		size_t size() const;
+		size_t numWords() const;
+		size_t count() const;
+
+		bool test(size_t bit) const;
+		void set(size_t bit);
+		void reset(size_t bit);
+		// true if this gained a bit
+		bool unionWith(const BitSet& other, const bitsetKernels& kernels);
+
+		uint64_t* data();
+		const uint64_t* data() const;
+
+		template <typename F>
+		void forEach(F f) const {
+			forEachBit(words.data(), 0, words.size(), f);
+		}
+
+	private:
+		std::vector<uint64_t> words;
+		size_t numBits;
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "dominators.h"
+#include "ssa.h"
+#include <algorithm>
+#include <utility>
+
+DominatorTree::DominatorTree() {
+	entry = -1;
+	iterations = 0;
+}
+
+void DominatorTree::clear() {
+	blocks.clear();
+	entry = -1;
+	idom.clear();
+	rpo.clear();
+	rpoNumber.clear();
+	childStart.clear();
+	children.clear();
+	frontierStart.clear();
+	frontier.clear();
+	iterations = 0;
+	succStart.clear();
+	succs.clear();
+	predStart.clear();
+	preds.clear();
+	treeEnter.clear();
+	treeExit.clear();
+	blockIndex.clear();
+}
+
+void DominatorTree::compute(const std::vector<BasicBlock*>& cfg, BasicBlock* entryBlock) {
+	clear();
+	blocks = cfg;
+	blockIndex.reserve(blocks.size());
+	for (int b = 0; b < (int)blocks.size(); b++) {
+		blockIndex.emplace(blocks[b], b);
+	}
+	entry = indexOf(entryBlock);
+	if (entry < 0) {
+		return;
+	}
+
+	buildEdges();
+	computeOrder();
+	computeIdoms();
+	computeChildren();
+	computeFrontiers();
+}
+
+int DominatorTree::indexOf(BasicBlock* bb) const {
+	auto found = blockIndex.find(bb);
+	if (found == blockIndex.end()) {
+		return -1;
+	}
+	return found->second;
+}
+
+BasicBlock* DominatorTree::immediateDominator(BasicBlock* bb) const {
+	int b = indexOf(bb);
+	if (b < 0 || idom[b] < 0) {
+		return nullptr;
+	}
+	return blocks[idom[b]];
+}
+
+bool DominatorTree::dominates(int a, int b) const {
+	if (!reachable(a) || !reachable(b)) {
+		return false;
+	}
+	return treeEnter[a] <= treeEnter[b] && treeEnter[b] <= treeExit[a];
+}
+
+bool DominatorTree::reachable(int b) const {
+	return b >= 0 && b < (int)rpoNumber.size() && rpoNumber[b] >= 0;
+}
+
+int DominatorTree::size() const {
+	return (int)blocks.size();
+}
+
+void DominatorTree::buildEdges() {
+	int n = size();
+	succStart.assign(n + 1, 0);
+	succs.reserve(n * 2);
+	for (int b = 0; b < n; b++) {
+		succStart[b] = (int)succs.size();
+		for (int kind = 0; kind < NUM_EDGE_KINDS; kind++) {
+			BasicBlock* target = blocks[b]->succ[kind];
+			int s = target == nullptr ? -1 : indexOf(target);
+			// a block both falling through and branching to s still only
+			// counts once as s's predecessor
+			if (s < 0 || std::find(succs.begin() + succStart[b], succs.end(), s) != succs.end()) {
+				continue;
+			}
+			succs.push_back(s);
+		}
+	}
+	succStart[n] = (int)succs.size();
+
+	predStart.assign(n + 1, 0);
+	for (int s : succs) {
+		predStart[s + 1]++;
+	}
+	for (int b = 0; b < n; b++) {
+		predStart[b + 1] += predStart[b];
+	}
+	preds.resize(succs.size());
+	std::vector<int> fill(predStart.begin(), predStart.end() - 1);
+	for (int b = 0; b < n; b++) {
+		for (int e = succStart[b]; e < succStart[b + 1]; e++) {
+			preds[fill[succs[e]]++] = b;
+		}
+	}
+}
+
+// depth first from the entry with an explicit stack, a long chain of
+// blocks would overflow the call stack
+void DominatorTree::computeOrder() {
+	int n = size();
+	rpoNumber.assign(n, -1);
+	rpo.clear();
+	rpo.reserve(n);
+
+	std::vector<char> seen(n, 0);
+	std::vector<std::pair<int, int>> stack;	// block, next edge to follow
+	seen[entry] = 1;
+	stack.push_back({ entry, succStart[entry] });
+	while (!stack.empty()) {
+		int b = stack.back().first;
+		int e = stack.back().second;
+		if (e < succStart[b + 1]) {
+			stack.back().second++;
+			int s = succs[e];
+			if (!seen[s]) {
+				seen[s] = 1;
+				stack.push_back({ s, succStart[s] });
+			}
+		} else {
+			rpo.push_back(b);
+			stack.pop_back();
+		}
+	}
+	std::reverse(rpo.begin(), rpo.end());
+	for (int i = 0; i < (int)rpo.size(); i++) {
+		rpoNumber[rpo[i]] = i;
+	}
+}
+
+// runs over the blocks in reverse postorder until nothing changes. doms
+// is indexed by and holds rpo numbers, so walking up from two blocks to
+// their common dominator only compares ints
+void DominatorTree::computeIdoms() {
+	int m = (int)rpo.size();
+	std::vector<int> doms(m, -1);
+	doms[0] = 0;
+
+	bool changed = true;
+	iterations = 0;
+	while (changed) {
+		changed = false;
+		iterations++;
+		for (int i = 1; i < m; i++) {
+			int b = rpo[i];
+			int newIdom = -1;
+			for (int e = predStart[b]; e < predStart[b + 1]; e++) {
+				int p = rpoNumber[preds[e]];
+				if (p < 0 || doms[p] < 0) {
+					continue;
+				}
+				if (newIdom < 0) {
+					newIdom = p;
+					continue;
+				}
+				int x = p;
+				while (x != newIdom) {
+					while (x > newIdom) {
+						x = doms[x];
+					}
+					while (newIdom > x) {
+						newIdom = doms[newIdom];
+					}
+				}
+			}
+			if (doms[i] != newIdom) {
+				doms[i] = newIdom;
+				changed = true;
+			}
+		}
+	}
+
+	idom.assign(size(), -1);
+	for (int i = 1; i < m; i++) {
+		idom[rpo[i]] = rpo[doms[i]];
+	}
+}
+
+// a block's dominator comes before it in reverse postorder, so one pass
+// backwards adds up subtree sizes and one pass forwards numbers each
+// subtree from its root
+void DominatorTree::computeChildren() {
+	int n = size();
+	childStart.assign(n + 1, 0);
+	for (int b = 0; b < n; b++) {
+		if (idom[b] >= 0) {
+			childStart[idom[b] + 1]++;
+		}
+	}
+	for (int b = 0; b < n; b++) {
+		childStart[b + 1] += childStart[b];
+	}
+	children.resize(childStart[n]);
+	std::vector<int> fill(childStart.begin(), childStart.end() - 1);
+	for (int b : rpo) {
+		if (idom[b] >= 0) {
+			children[fill[idom[b]]++] = b;
+		}
+	}
+
+	std::vector<int> subtreeSize(n, 1);
+	for (int i = (int)rpo.size() - 1; i > 0; i--) {
+		subtreeSize[idom[rpo[i]]] += subtreeSize[rpo[i]];
+	}
+	treeEnter.assign(n, -1);
+	treeExit.assign(n, -1);
+	treeEnter[entry] = 0;
+	for (int b : rpo) {
+		int next = treeEnter[b] + 1;
+		for (int c = childStart[b]; c < childStart[b + 1]; c++) {
+			treeEnter[children[c]] = next;
+			next += subtreeSize[children[c]];
+		}
+		treeExit[b] = treeEnter[b] + subtreeSize[b] - 1;
+	}
+}
+
+// b is in the frontier of everything on the dominator tree path from each
+// of its predecessors up to, but not including, b's immediate dominator.
+// only joins have a frontier to add to, and the entry counts as one since
+// it is also reached from outside the function
+void DominatorTree::computeFrontiers() {
+	int n = size();
+	std::vector<std::pair<int, int>> found;	// block, block in its frontier
+	std::vector<int> lastAdded(n, -1);
+	for (int b : rpo) {
+		if (predStart[b + 1] - predStart[b] < 2 && b != entry) {
+			continue;
+		}
+		for (int e = predStart[b]; e < predStart[b + 1]; e++) {
+			int runner = preds[e];
+			if (!reachable(runner)) {
+				continue;
+			}
+			while (runner != idom[b] && runner >= 0) {
+				if (lastAdded[runner] != b) {
+					lastAdded[runner] = b;
+					found.push_back({ runner, b });
+				}
+				runner = idom[runner];
+			}
+		}
+	}
+
+	frontierStart.assign(n + 1, 0);
+	for (auto& df : found) {
+		frontierStart[df.first + 1]++;
+	}
+	for (int b = 0; b < n; b++) {
+		frontierStart[b + 1] += frontierStart[b];
+	}
+	frontier.resize(found.size());
+	std::vector<int> fill(frontierStart.begin(), frontierStart.end() - 1);
+	for (auto& df : found) {
+		frontier[fill[df.first]++] = df.second;
+	}
+}
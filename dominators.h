@@ -0,0 +1,65 @@
+#ifndef __DOMINATORS_H__
+#define __DOMINATORS_H__
+
+#include <vector>
+#include <unordered_map>
+
+class BasicBlock;
+
+// Dominator tree and dominance frontiers of a cfg, computed iteratively as
+// in Cooper, Harvey and Kennedy's "A Simple, Fast Dominance Algorithm".
+// The edges are the ones in each block's succ array. Blocks are numbered by
+// their position in the vector handed to compute(), and everything below
+// is an array indexed by that number. Lists per block are packed into one
+// array, block b's entries being [start[b], start[b + 1]).
+class DominatorTree {
+	public:
+		DominatorTree();
+
+		void compute(const std::vector<BasicBlock*>& cfg, BasicBlock* entry);
+		void clear();
+
+		// -1 for blocks not in the cfg
+		int indexOf(BasicBlock* bb) const;
+		// nullptr for the entry and blocks it can't reach
+		BasicBlock* immediateDominator(BasicBlock* bb) const;
+		// every block dominates itself, unreachable blocks dominate nothing
+		bool dominates(int a, int b) const;
+		bool reachable(int b) const;
+		int size() const;
+
+		std::vector<BasicBlock*> blocks;
+		int entry;
+
+		std::vector<int> idom;			// -1 for the entry and unreachable blocks
+		std::vector<int> rpo;			// reachable blocks in reverse postorder
+		std::vector<int> rpoNumber;		// position in rpo, -1 if unreachable
+
+		std::vector<int> childStart;	// dominator tree children
+		std::vector<int> children;
+		std::vector<int> frontierStart;	// dominance frontiers
+		std::vector<int> frontier;
+
+		int iterations;					// passes over rpo until idom settled
+
+	private:
+		// edges in both directions, packed the same way
+		std::vector<int> succStart;
+		std::vector<int> succs;
+		std::vector<int> predStart;
+		std::vector<int> preds;
+
+		// preorder interval of each block's subtree, for dominates()
+		std::vector<int> treeEnter;
+		std::vector<int> treeExit;
+
+		std::unordered_map<BasicBlock*, int> blockIndex;
+
+		void buildEdges();
+		void computeOrder();
+		void computeIdoms();
+		void computeChildren();
+		void computeFrontiers();
+};
+
+#endif
@@ -0,0 +1,381 @@
+#include "interference.h"
+#include <algorithm>
+
+// 128 MB of matrix, about 46000 nodes
+static const uint64_t MAX_MATRIX_BITS = (uint64_t)1 << 30;
+
+InterferenceGraph::InterferenceGraph() {
+	edges = 0;
+	matrixEdges = true;
+}
+
+void InterferenceGraph::reset(int numNodes) {
+	clear();
+	uint64_t bits = matrixBit(numNodes, 0);
+	matrixEdges = bits <= MAX_MATRIX_BITS;
+	if (matrixEdges) {
+		matrix.assign((bits + 63) / 64, 0);
+	}
+	adjacency.resize(numNodes);
+	values.assign(numNodes, nullptr);
+}
+
+void InterferenceGraph::clear() {
+	matrix.clear();
+	edgeTable.clear();
+	adjacency.clear();
+	values.clear();
+	edges = 0;
+	matrixEdges = true;
+}
+
+uint64_t InterferenceGraph::matrixBit(int a, int b) {
+	if (a < b) {
+		std::swap(a, b);
+	}
+	return (uint64_t)a * (a - 1) / 2 + b;
+}
+
+uint64_t InterferenceGraph::edgeKey(int a, int b) {
+	if (a < b) {
+		std::swap(a, b);
+	}
+	return ((uint64_t)a << 32) | (uint32_t)b;
+}
+
+bool InterferenceGraph::addEdge(int a, int b) {
+	if (a == b) {
+		return false;
+	}
+	if (matrixEdges) {
+		uint64_t bit = matrixBit(a, b);
+		uint64_t mask = (uint64_t)1 << (bit % 64);
+		if (matrix[bit / 64] & mask) {
+			return false;
+		}
+		matrix[bit / 64] |= mask;
+	} else if (!hashInsert(edgeKey(a, b))) {
+		return false;
+	}
+	adjacency[a].push_back(b);
+	adjacency[b].push_back(a);
+	edges++;
+	return true;
+}
+
+size_t InterferenceGraph::hashSlot(uint64_t key) const {
+	key ^= key >> 33;
+	key *= 0xFF51AFD7ED558CCDull;
+	key ^= key >> 33;
+	return (size_t)key & (edgeTable.size() - 1);
+}
+
+bool InterferenceGraph::hashInsert(uint64_t key) {
+	if ((uint64_t)(edges + 1) * 2 > edgeTable.size()) {
+		std::vector<uint64_t> old;
+		old.swap(edgeTable);
+		edgeTable.assign(old.empty() ? 1024 : old.size() * 2, 0);
+		for (uint64_t oldKey : old) {
+			if (oldKey != 0) {
+				size_t slot = hashSlot(oldKey);
+				while (edgeTable[slot] != 0) {
+					slot = (slot + 1) & (edgeTable.size() - 1);
+				}
+				edgeTable[slot] = oldKey;
+			}
+		}
+	}
+	size_t slot = hashSlot(key);
+	while (edgeTable[slot] != 0) {
+		if (edgeTable[slot] == key) {
+			return false;
+		}
+		slot = (slot + 1) & (edgeTable.size() - 1);
+	}
+	edgeTable[slot] = key;
+	return true;
+}
+
+bool InterferenceGraph::hashContains(uint64_t key) const {
+	if (edgeTable.empty()) {
+		return false;
+	}
+	size_t slot = hashSlot(key);
+	while (edgeTable[slot] != 0) {
+		if (edgeTable[slot] == key) {
+			return true;
+		}
+		slot = (slot + 1) & (edgeTable.size() - 1);
+	}
+	return false;
+}
+
+void InterferenceGraph::hashErase(uint64_t key) {
+	if (edgeTable.empty()) {
+		return;
+	}
+	size_t mask = edgeTable.size() - 1;
+	size_t hole = hashSlot(key);
+	while (edgeTable[hole] != key) {
+		if (edgeTable[hole] == 0) {
+			return;
+		}
+		hole = (hole + 1) & mask;
+	}
+	// an entry after the hole moves into it unless its home slot lies
+	// between the two
+	size_t slot = hole;
+	while (true) {
+		slot = (slot + 1) & mask;
+		if (edgeTable[slot] == 0) {
+			break;
+		}
+		size_t home = hashSlot(edgeTable[slot]);
+		if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+			edgeTable[hole] = edgeTable[slot];
+			hole = slot;
+		}
+	}
+	edgeTable[hole] = 0;
+}
+
+void InterferenceGraph::hashClear() {
+	std::fill(edgeTable.begin(), edgeTable.end(), 0);
+}
+
+// order in the neighbor lists isn't kept, the last one takes the place of
+// the one removed
+static void removeNeighbor(std::vector<int>& list, int n) {
+	auto found = std::find(list.begin(), list.end(), n);
+	if (found != list.end()) {
+		*found = list.back();
+		list.pop_back();
+	}
+}
+
+void InterferenceGraph::removeEdge(int a, int b) {
+	if (!interferes(a, b)) {
+		return;
+	}
+	if (matrixEdges) {
+		uint64_t bit = matrixBit(a, b);
+		matrix[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+	} else {
+		hashErase(edgeKey(a, b));
+	}
+	removeNeighbor(adjacency[a], b);
+	removeNeighbor(adjacency[b], a);
+	edges--;
+}
+
+bool InterferenceGraph::interferes(int a, int b) const {
+	if (a == b) {
+		return false;
+	}
+	if (matrixEdges) {
+		uint64_t bit = matrixBit(a, b);
+		return (matrix[bit / 64] >> (bit % 64)) & 1;
+	}
+	return hashContains(edgeKey(a, b));
+}
+
+const std::vector<int>& InterferenceGraph::neighbors(int n) const {
+	return adjacency[n];
+}
+
+int InterferenceGraph::degree(int n) const {
+	return (int)adjacency[n].size();
+}
+
+int InterferenceGraph::size() const {
+	return (int)adjacency.size();
+}
+
+int InterferenceGraph::numEdges() const {
+	return edges;
+}
+
+bool InterferenceGraph::usesMatrix() const {
+	return matrixEdges;
+}
+
+// the neighbors of a node that stays are gathered from it and everything
+// merged into it, then the matrix or hash is filled again from scratch
+void InterferenceGraph::mergeNodes(const std::vector<int>& into) {
+	int numNodes = size();
+	// the nodes merged into n, chained from n
+	std::vector<int> nextMerged(numNodes, -1);
+	for (int n = 0; n < numNodes; n++) {
+		if (into[n] != n) {
+			nextMerged[n] = nextMerged[into[n]];
+			nextMerged[into[n]] = n;
+		}
+	}
+	std::vector<std::vector<int>> oldAdjacency;
+	oldAdjacency.swap(adjacency);
+	adjacency.resize(numNodes);
+	std::vector<int> seenBy(numNodes, -1);
+	for (int n = 0; n < numNodes; n++) {
+		if (into[n] != n) {
+			continue;
+		}
+		for (int member = n; member != -1; member = nextMerged[member]) {
+			for (int neighbor : oldAdjacency[member]) {
+				int other = into[neighbor];
+				if (other != n && seenBy[other] != n) {
+					seenBy[other] = n;
+					adjacency[n].push_back(other);
+				}
+			}
+		}
+	}
+
+	if (matrixEdges) {
+		std::fill(matrix.begin(), matrix.end(), 0);
+	} else {
+		hashClear();
+	}
+	edges = 0;
+	for (int a = 0; a < numNodes; a++) {
+		for (int b : adjacency[a]) {
+			if (b < a) {
+				if (matrixEdges) {
+					uint64_t bit = matrixBit(a, b);
+					matrix[bit / 64] |= (uint64_t)1 << (bit % 64);
+				} else {
+					hashInsert(edgeKey(a, b));
+				}
+				edges++;
+			}
+		}
+	}
+}
+
+// start node sets
+
+void NodeSets::reset(int numNodes) {
+	parent.resize(numNodes);
+	sizes.assign(numNodes, 1);
+	leaders.resize(numNodes);
+	ring.resize(numNodes);
+	for (int node = 0; node < numNodes; node++) {
+		parent[node] = node;
+		leaders[node] = node;
+		ring[node] = node;
+	}
+}
+
+int NodeSets::find(int node) {
+	while (parent[node] != node) {
+		parent[node] = parent[parent[node]];
+		node = parent[node];
+	}
+	return node;
+}
+
+int NodeSets::leader(int node) {
+	return leaders[find(node)];
+}
+
+int NodeSets::size(int node) {
+	return sizes[find(node)];
+}
+
+void NodeSets::unite(int keep, int other) {
+	int keepRoot = find(keep);
+	int otherRoot = find(other);
+	if (keepRoot == otherRoot) {
+		return;
+	}
+	int keepLeader = leaders[keepRoot];
+	if (sizes[keepRoot] < sizes[otherRoot]) {
+		std::swap(keepRoot, otherRoot);
+	}
+	parent[otherRoot] = keepRoot;
+	sizes[keepRoot] += sizes[otherRoot];
+	leaders[keepRoot] = keepLeader;
+	std::swap(ring[keepRoot], ring[otherRoot]);
+}
+
+// start degree buckets
+
+DegreeBuckets::DegreeBuckets() {
+	minDegree = 0;
+	count = 0;
+}
+
+void DegreeBuckets::reset(int numNodes) {
+	heads.clear();
+	next.assign(numNodes, -1);
+	prev.assign(numNodes, -1);
+	degrees.assign(numNodes, -1);
+	minDegree = 0;
+	count = 0;
+}
+
+void DegreeBuckets::insert(int node, int degree) {
+	if (degree >= (int)heads.size()) {
+		heads.resize(degree + 1, -1);
+	}
+	degrees[node] = degree;
+	prev[node] = -1;
+	next[node] = heads[degree];
+	if (heads[degree] != -1) {
+		prev[heads[degree]] = node;
+	}
+	heads[degree] = node;
+	if (count == 0 || degree < minDegree) {
+		minDegree = degree;
+	}
+	count++;
+}
+
+void DegreeBuckets::remove(int node) {
+	int degree = degrees[node];
+	if (degree < 0) {
+		return;
+	}
+	if (prev[node] != -1) {
+		next[prev[node]] = next[node];
+	} else {
+		heads[degree] = next[node];
+	}
+	if (next[node] != -1) {
+		prev[next[node]] = prev[node];
+	}
+	degrees[node] = -1;
+	count--;
+}
+
+void DegreeBuckets::decrement(int node) {
+	int degree = degrees[node];
+	if (degree <= 0) {
+		return;
+	}
+	remove(node);
+	insert(node, degree - 1);
+}
+
+bool DegreeBuckets::contains(int node) const {
+	return degrees[node] >= 0;
+}
+
+int DegreeBuckets::degree(int node) const {
+	return degrees[node];
+}
+
+bool DegreeBuckets::empty() const {
+	return count == 0;
+}
+
+int DegreeBuckets::popMin() {
+	if (count == 0) {
+		return -1;
+	}
+	while (heads[minDegree] == -1) {
+		minDegree++;
+	}
+	int node = heads[minDegree];
+	remove(node);
+	return node;
+}
@@ -0,0 +1,118 @@
+#ifndef __INTERFERENCE_H__
+#define __INTERFERENCE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SSAValue;
+
+// Interference graph over dense node ids, the way Chaitin and Briggs keep
+// it: a triangular bit matrix answers whether two nodes interfere and a
+// vector per node lists its neighbors for iterating. Graphs too big for
+// the matrix keep their edges in an open addressing hash table instead.
+class InterferenceGraph {
+	public:
+		InterferenceGraph();
+
+		// numNodes nodes and no edges
+		void reset(int numNodes);
+		void clear();
+
+		// false for a == b and edges already there
+		bool addEdge(int a, int b);
+		void removeEdge(int a, int b);
+		bool interferes(int a, int b) const;
+		const std::vector<int>& neighbors(int n) const;
+		int degree(int n) const;
+		int size() const;
+		int numEdges() const;
+		bool usesMatrix() const;
+
+		// every node n becomes into[n] at once, edges of a merged node move
+		// to what it merged into and it's left with none. into[into[n]]
+		// must be into[n] and merged nodes mustn't interfere
+		void mergeNodes(const std::vector<int>& into);
+
+		std::vector<SSAValue*> values;	// the value each node was made for
+
+	private:
+		// bit for a > b, row a starts at a * (a - 1) / 2
+		static uint64_t matrixBit(int a, int b);
+		// never 0, 0 marks an empty slot
+		static uint64_t edgeKey(int a, int b);
+		// linear probing, deleting shifts the entries after back
+		size_t hashSlot(uint64_t key) const;
+		bool hashInsert(uint64_t key);
+		bool hashContains(uint64_t key) const;
+		void hashErase(uint64_t key);
+		void hashClear();
+
+		std::vector<uint64_t> matrix;
+		std::vector<uint64_t> edgeTable;	// size is a power of 2 and at least twice the edges
+		std::vector<std::vector<int>> adjacency;
+		int edges;
+		bool matrixEdges;
+};
+
+// disjoint sets of nodes for coalescing, union by size with path halving.
+// every set keeps the node it was made for as its leader and its members
+// in a ring, joining two sets splices their rings
+class NodeSets {
+	public:
+		// every node alone in its own set
+		void reset(int numNodes);
+		int find(int node);
+		int leader(int node);
+		int size(int node);
+		// other's set joins keep's, the leader of keep's set stays
+		void unite(int keep, int other);
+
+		// calls f with every node in node's set until f returns false
+		template <typename F>
+		void forEachMember(int node, F f) const {
+			int member = node;
+			do {
+				if (!f(member)) {
+					return;
+				}
+				member = ring[member];
+			} while (member != node);
+		}
+
+	private:
+		std::vector<int> parent;
+		std::vector<int> sizes;
+		std::vector<int> leaders;
+		std::vector<int> ring;
+};
+
+// nodes kept in one list per degree, for simplify. the lowest non empty
+// bucket only moves down one at a time when a degree drops, so finding
+// it again is paid for by the decrements
+class DegreeBuckets {
+	public:
+		DegreeBuckets();
+
+		// no nodes, room for ids below numNodes
+		void reset(int numNodes);
+		void insert(int node, int degree);
+		void remove(int node);
+		// node's degree goes down by one
+		void decrement(int node);
+		bool contains(int node) const;
+		int degree(int node) const;
+		bool empty() const;
+		// takes out a node of the lowest degree, -1 if there are none
+		int popMin();
+
+	private:
+		std::vector<int> heads;		// first node of every degree
+		std::vector<int> next;
+		std::vector<int> prev;
+		std::vector<int> degrees;	// -1 for nodes not in a bucket
+		int minDegree;
+		int count;
+};
+
+#endif
@@ -1,59 +1,218 @@
 #include "lexer.h"
 #include <string>
-#include <fstream>
 #include <iostream>
 #include <sstream>
-#include <regex>
 #include <vector>
+#include <algorithm>
+#include <thread>
+#include <exception>
 
 #include "token.h"
 
+Lexer::Lexer() {
+	scan = &getScanKernels(detectScanLevel());
+	trackLines = false;
+	incrementalValid = false;
+	resetScan();
+}
+
+void Lexer::setScanLevel(scanLevel level) {
+	scan = &getScanKernels(level);
+}
+
+scanLevel Lexer::getScanLevel() {
+	return scan->level;
+}
+
 void Lexer::setFile(std::string fileName) {
-	infile.open(fileName);
+	source.readFile(fileName);
+	resetScan();
+}
+
+void Lexer::mapFile(std::string fileName) {
+	source.mapFile(fileName);
+	resetScan();
+}
+
+void Lexer::setSource(std::string_view text) {
+	source.setText(text);
+	resetScan();
 }
 
-bool Lexer::isDigit(const char* ch) {
-	std::regex reg("[0-9]");
-	return std::regex_match(ch, reg);
+void Lexer::setSource(const char* data, size_t length) {
+	setSource(std::string_view(data, length));
 }
 
-bool Lexer::isLetter(const char* ch) {
-	std::regex reg("[a-zA-Z]");
-	return std::regex_match(ch, reg);
+void Lexer::copySource(std::string_view text) {
+	source.copyText(text);
+	resetScan();
 }
 
-bool Lexer::isAlphanum(const char* ch) {
-	std::regex reg("[a-zA-Z0-9]");
-	return std::regex_match(ch, reg);
+void Lexer::resetScan() {
+	tokens.clear();
+	text = source.text();
+	line = std::string_view();
+	nextLineStart = 0;
+	lineNumber = 0;
+	column = 0;
+	accumStartIdx = 0;
+	st = IDLE;
+	inLine = false;
+	trackLines = false;
+	incrementalValid = false;
+	lineStarts.clear();
+	lineEndsInComment.clear();
 }
 
-bool Lexer::isRelationalOpStem(const char* ch) {
-	std::regex reg("[!<>=]");
-	return std::regex_match(ch, reg);
+const Lexer::dfaTables& Lexer::tables() {
+	static const dfaTables dfa;
+	return dfa;
 }
 
-int Lexer::isKeyword(std::string accumulator) {
-	std::string keywords[14] = {
-		"let",
-		"var",
-		"if",
-		"then",
-		"else",
-		"fi",
-		"while",
-		"do",
-		"od",
-		"void",
-		"function",
-		"call",
-		"return",
-		"main"
-	};
-	for(int i = 0; i < 14; ++i) {
-		if(accumulator.compare(keywords[i]) == 0) {
-			return i;
+Lexer::dfaTables::dfaTables() {
+	// character classes
+	for (int c = 0; c < 256; c++) {
+		charClasses[c] = CC_OTHER;
+		charTokens[c] = IDENT;
+	}
+	for (int c = '0'; c <= '9'; c++) {
+		charClasses[c] = CC_DIGIT;
+	}
+	for (int c = 'a'; c <= 'z'; c++) {
+		charClasses[c] = CC_LETTER;
+		charClasses[c - 'a' + 'A'] = CC_LETTER;
+	}
+	charClasses['!'] = CC_NOT;
+	charClasses['<'] = CC_LT;
+	charClasses['>'] = CC_GT;
+	charClasses['='] = CC_EQ;
+	charClasses['/'] = CC_SLASH;
+	charClasses['*'] = CC_STAR;
+	charClasses['-'] = CC_DASH;
+	charClasses['\0'] = CC_EOL;
+
+	// single character tokens
+	const char punct[] = { '(', ')', '{', '}', ',', ';', '.', '+' };
+	const tokenType punctTokens[] = { L_PAREN, R_PAREN, L_BRACE, R_BRACE, COMMA, SEMICOLON, PERIOD, ADD };
+	for (int i = 0; i < 8; i++) {
+		charClasses[(unsigned char)punct[i]] = CC_PUNCT;
+		charTokens[(unsigned char)punct[i]] = punctTokens[i];
+	}
+	charTokens['*'] = MUL;
+	charTokens['-'] = SUB;
+
+	// transitions, every row starts out as "lexeme ended before this char"
+	// and is then overridden with the characters that extend the lexeme
+	for (int st = 0; st < NUM_STATES; st++) {
+		for (int cc = 0; cc < NUM_CHAR_CLASSES; cc++) {
+			transitions[st][cc] = { EMIT_BEFORE, IDLE, IDENT };
 		}
 	}
+
+	transition* idle = transitions[IDLE];
+	for (int cc = 0; cc < NUM_CHAR_CLASSES; cc++) {
+		idle[cc] = { SKIP, IDLE, IDENT };
+	}
+	idle[CC_DIGIT] = { START, IN_NUMBER, NUMBER };
+	idle[CC_LETTER] = { START, IN_IDENT, IDENT };
+	idle[CC_NOT] = { START, SUCC_NOT, NEQ };
+	idle[CC_LT] = { START, SUCC_LT, LT };
+	idle[CC_GT] = { START, SUCC_GT, GT };
+	idle[CC_EQ] = { START, SUCC_EQ, EQ };
+	idle[CC_SLASH] = { START, SUCC_DIV, DIV };
+	idle[CC_STAR] = { EMIT_CHAR, IDLE, MUL };
+	idle[CC_DASH] = { EMIT_CHAR, IDLE, SUB };
+	idle[CC_PUNCT] = { EMIT_CHAR, IDLE, IDENT };
+
+	for (int cc = 0; cc < NUM_CHAR_CLASSES; cc++) {
+		transitions[IN_NUMBER][cc].token = NUMBER;
+		transitions[IN_IDENT][cc].token = IDENT;
+		transitions[SUCC_NOT][cc] = { FAIL, IDLE, NEQ };
+		transitions[SUCC_LT][cc].token = LT;
+		transitions[SUCC_GT][cc].token = GT;
+		transitions[SUCC_EQ][cc] = { FAIL, IDLE, EQ };
+		transitions[SUCC_DIV][cc].token = DIV;
+		transitions[IN_COMMENT][cc] = { SKIP, IN_COMMENT, IDENT };
+		transitions[SUCC_STAR][cc] = { SKIP, IN_COMMENT, IDENT };
+		// the rest of the line after a closing */ is skipped
+		transitions[EXIT_COMMENT][cc] = { SKIP, EXIT_COMMENT, IDENT };
+	}
+	transitions[IN_NUMBER][CC_DIGIT] = { SKIP, IN_NUMBER, NUMBER };
+	transitions[IN_IDENT][CC_DIGIT] = { SKIP, IN_IDENT, IDENT };
+	transitions[IN_IDENT][CC_LETTER] = { SKIP, IN_IDENT, IDENT };
+	transitions[SUCC_NOT][CC_EQ] = { EMIT_WITH, IDLE, NEQ };
+	transitions[SUCC_LT][CC_DASH] = { EMIT_WITH, IDLE, ASSIGN };
+	transitions[SUCC_LT][CC_EQ] = { EMIT_WITH, IDLE, LE };
+	transitions[SUCC_GT][CC_EQ] = { EMIT_WITH, IDLE, GE };
+	transitions[SUCC_EQ][CC_EQ] = { EMIT_WITH, IDLE, EQ };
+	// the '*' opening a comment can also be the start of the closing "*/"
+	transitions[SUCC_DIV][CC_STAR] = { SKIP, SUCC_STAR, IDENT };
+	transitions[IN_COMMENT][CC_STAR] = { SKIP, SUCC_STAR, IDENT };
+	transitions[SUCC_STAR][CC_STAR] = { SKIP, SUCC_STAR, IDENT };
+	transitions[SUCC_STAR][CC_SLASH] = { SKIP, EXIT_COMMENT, IDENT };
+}
+
+// keywords in tokenType order, LET..MAIN
+static constexpr std::string_view keywords[14] = {
+	"let",
+	"var",
+	"if",
+	"then",
+	"else",
+	"fi",
+	"while",
+	"do",
+	"od",
+	"void",
+	"function",
+	"call",
+	"return",
+	"main"
+};
+
+static constexpr size_t minKeywordLength = 2;
+static constexpr size_t maxKeywordLength = 8;
+static constexpr unsigned int keywordSlots = 32;
+
+// perfect hash over the keywords above, checked at compile time
+static constexpr unsigned int keywordHash(std::string_view word) {
+	return ((unsigned int)word.size() +
+		2 * (unsigned char)word.front() +
+		19 * (unsigned char)word.back()) & (keywordSlots - 1);
+}
+
+struct keywordTable {
+	signed char slots[keywordSlots];
+	bool perfect;
+};
+
+static constexpr keywordTable buildKeywordTable() {
+	keywordTable table = {};
+	table.perfect = true;
+	for (unsigned int i = 0; i < keywordSlots; i++) {
+		table.slots[i] = -1;
+	}
+	for (int i = 0; i < 14; i++) {
+		unsigned int slot = keywordHash(keywords[i]);
+		if (table.slots[slot] != -1) {
+			table.perfect = false;
+		}
+		table.slots[slot] = (signed char)i;
+	}
+	return table;
+}
+
+static constexpr keywordTable keywordLookup = buildKeywordTable();
+static_assert(keywordLookup.perfect, "keywordHash has collisions, pick new multipliers");
+
+int Lexer::isKeyword(std::string_view accumulator) {
+	if (accumulator.size() < minKeywordLength || accumulator.size() > maxKeywordLength) {
+		return -1;
+	}
+	int kwInd = keywordLookup.slots[keywordHash(accumulator)];
+	if (kwInd != -1 && keywords[kwInd] == accumulator) {
+		return kwInd;
+	}
 	return -1;
 }
 
@@ -63,379 +222,534 @@ void Lexer::displayTokens() {
 	std::cout << "Total tokens found: " << tokens.size() << std::endl;
 	std::cout << "ID    Type        Ln[Cn]     Value" << std::endl;
 	for (int i = 0; i < tokens.size(); i++) {
-		tokens[i].displayToken(i);
+		pool.displayToken(tokens[i], i);
 	}
 }
 
-std::vector<Token> Lexer::getTokens() {
+const std::vector<Token>& Lexer::getTokens() {
 	return tokens;
 }
 
+TokenPool* Lexer::getPool() {
+	return &pool;
+}
+
+
+Token Lexer::makeLexemeToken(tokenType type, int columnNumber, std::string_view value) {
+	if (type == IDENT) {
+		int kwInd = isKeyword(value);
+		if (kwInd != -1) {
+			type = static_cast<tokenType>(kwInd);
+		}
+	}
+	if (type == IDENT || type == NUMBER) {
+		return Token(type, lineNumber, columnNumber, pool.intern(value));
+	}
+	// keywords and operators are always spelled the same
+	return Token(type, lineNumber, columnNumber);
+}
 
 void Lexer::tokenize() {
 	//std::cout << "Lexer is starting..." << std::endl;
-	if (infile.is_open()) {
-		std::string line;
-		int lineNumber = 0;
-		state st = IDLE;
-		while (std::getline(infile, line)) {
+	Token token;
+	while (scanToken(token)) {
+		tokens.push_back(token);
+	}
+}
+
+// lexes chunk into tokens and pool, line numbers start at firstLine.
+// st is left as the state at the end of the chunk
+void Lexer::lexChunk(std::string_view chunk, int firstLine, state startState) {
+	tokens.clear();
+	text = chunk;
+	line = std::string_view();
+	nextLineStart = 0;
+	lineNumber = firstLine - 1;
+	column = 0;
+	accumStartIdx = 0;
+	st = startState;
+	inLine = false;
+	tokenize();
+}
+
+int Lexer::hardwareThreads() {
+	return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+void Lexer::tokenizeParallel(int numThreads) {
+	// small sources aren't worth the threads
+	const size_t minChunkSize = 64 * 1024;
+	std::string_view whole = source.text();
+	if (numThreads < 2 || whole.size() < 2 * minChunkSize) {
+		tokenize();
+		return;
+	}
+	int numChunks = (int)std::min<size_t>(numThreads, whole.size() / minChunkSize);
+
+	// chunks end right after a '\n' so every chunk starts on a new line
+	std::vector<std::string_view> chunks;
+	std::vector<int> firstLines;
+	size_t start = 0;
+	int linesBefore = 0;
+	for (int i = 0; i < numChunks && start < whole.size(); i++) {
+		size_t end = whole.size();
+		if (i < numChunks - 1) {
+			end = whole.find('\n', std::max(start, whole.size() * (i + 1) / numChunks));
+			end = (end == std::string_view::npos) ? whole.size() : end + 1;
+		}
+		chunks.push_back(whole.substr(start, end - start));
+		firstLines.push_back(linesBefore + 1);
+		linesBefore += (int)std::count(whole.begin() + start, whole.begin() + end, '\n');
+		start = end;
+	}
+	numChunks = (int)chunks.size();
+
+	// only IN_COMMENT carries over from one line to the next, so every chunk
+	// is lexed speculatively as if it started outside of a comment
+	std::vector<Lexer> chunkLexers(numChunks);
+	std::vector<std::exception_ptr> errors(numChunks);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < numChunks; i++) {
+		chunkLexers[i].scan = scan;
+		workers.push_back(std::thread([&, i]() {
+			try {
+				chunkLexers[i].lexChunk(chunks[i], firstLines[i], IDLE);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	// in order, a chunk that really starts inside of a comment is lexed again.
+	// errors only count once the chunk's start state is known to be right
+	bool inComment = false;
+	size_t totalTokens = 0;
+	for (int i = 0; i < numChunks; i++) {
+		if (inComment) {
+			errors[i] = nullptr;
+			try {
+				chunkLexers[i].lexChunk(chunks[i], firstLines[i], IN_COMMENT);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+		if (errors[i]) {
+			std::rethrow_exception(errors[i]);
+		}
+		inComment = (chunkLexers[i].st == IN_COMMENT);
+		totalTokens += chunkLexers[i].tokens.size();
+	}
+
+	// stitch, identifier and number values move over to this lexer's pool.
+	// they are interned on first use so the pool ends up in the same order
+	// as with tokenize(), and values left over from a re-lexed chunk are dropped
+	tokens.clear();
+	tokens.reserve(totalTokens);
+	for (int i = 0; i < numChunks; i++) {
+		const TokenPool& chunkPool = chunkLexers[i].pool;
+		std::vector<unsigned int> remap(chunkPool.size(), Token::NO_VALUE);
+		for (const Token& token : chunkLexers[i].tokens) {
+			unsigned int valIndex = token.getValueIndex();
+			if (valIndex == Token::NO_VALUE) {
+				tokens.push_back(token);
+			} else {
+				if (remap[valIndex] == Token::NO_VALUE) {
+					remap[valIndex] = pool.intern(chunkPool.at(valIndex));
+				}
+				tokens.push_back(Token(token.getType(), token.getLineNumber(), token.getColumnNumber(), remap[valIndex]));
+			}
+		}
+	}
+
+	// scanToken() continues at the end of the source
+	nextLineStart = whole.size();
+	lineNumber = linesBefore;
+	inLine = false;
+}
+
+bool Lexer::scanToken(Token& token) {
+	const dfaTables& dfa = tables();
+	while (true) {
+		if (!inLine) {
+			if (nextLineStart >= text.size()) {
+				return false;
+			}
+			size_t lineEnd = text.find('\n', nextLineStart);
+			if (lineEnd == std::string_view::npos) {
+				lineEnd = text.size();
+			}
+			if (trackLines) {
+				lineStarts.push_back(nextLineStart);
+			}
+			line = text.substr(nextLineStart, lineEnd - nextLineStart);
+			nextLineStart = lineEnd + 1;
+
 			lineNumber += 1;
-			std::string accumulator = "";
-			int columnNumber = 0;
-			int accumStartIdx = 0;
+			column = 0;
+			accumStartIdx = 0;
+			inLine = true;
 
 			if (st != IN_COMMENT) {
 				st = IDLE;
 			}
+		}
 
-			for (int i = 0; i < line.size(); i++) {
-				columnNumber += 1;
-				char el = line[i];
+		// column == line.size() is the end of the line, fed to the dfa as CC_EOL
+		while (column <= (int)line.size()) {
+			// runs of chars that leave the state as is are skipped in bulk,
+			// the dfa then picks up on the char that ends the run
+			if (column < (int)line.size()) {
+				const char* p = line.data() + column;
+				size_t rest = line.size() - column;
+				switch (st) {
+					case IDLE: column += (int)scan->spanWhitespace(p, rest); break;
+					case IN_IDENT: column += (int)scan->spanIdent(p, rest); break;
+					case IN_NUMBER: column += (int)scan->spanDigits(p, rest); break;
+					// anything up to the "*/" stays in the comment
+					case IN_COMMENT: column += (int)scan->findCommentEnd(p, rest); break;
+					case EXIT_COMMENT: column = (int)line.size(); break;
+					default: break;
+				}
+			}
 
-				std::string str(1, el);
-				const char* ch = str.c_str();
+			int columnNumber = column + 1;
+			unsigned char el = (column < (int)line.size()) ? line[column] : '\0';
+			const transition& t = dfa.transitions[st][dfa.charClasses[el]];
+
+			switch (t.act) {
+				case EMIT_BEFORE: {
+					// lexeme ended on the previous char, the current char is
+					// classified again from IDLE on the next call
+					token = makeLexemeToken(t.token, accumStartIdx, line.substr(accumStartIdx - 1, columnNumber - accumStartIdx));
+					st = IDLE;
+					return true;
+				}
+				case START: {
+					accumStartIdx = columnNumber;
+				} break;
+				case EMIT_CHAR: {
+					token = Token(dfa.charTokens[el], lineNumber, columnNumber);
+					st = t.next;
+					column += 1;
+					return true;
+				}
+				case EMIT_WITH: {
+					token = Token(t.token, lineNumber, accumStartIdx);
+					st = t.next;
+					column += 1;
+					return true;
+				}
+				case FAIL: {
+					if (st == SUCC_NOT) {
+						throw(LexerError("Symbol '!' must be followed by Symbol '='", lineNumber, accumStartIdx));
+					} else {
+						throw(LexerError("Symbol '=' must be followed by Symbol '='", lineNumber, accumStartIdx));
+					}
+				} break;
+				default:
+					break;
+			}
+			st = t.next;
+			column += 1;
+		}
+		inLine = false;
+		if (trackLines) {
+			lineEndsInComment.push_back(st == IN_COMMENT);
+		}
+	}
+}
 
-				switch (st) {
-					case IDLE: {
-						if (isDigit(ch)) {
-							st = IN_NUMBER;
-							std::string digit(1, el);
-							accumulator.append(digit);
-							accumStartIdx = columnNumber;
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (!isDigit(nextCh)) {
-								Token* number = new Token(NUMBER, lineNumber, accumStartIdx, accumulator);
-								tokens.push_back(*number);
-								st = IDLE;
-								accumulator = "";
-							}
-						} else if (isLetter(ch)) {
-							st = IN_IDENT;
-							std::string letter(1, el);
-							accumulator.append(letter);
-							accumStartIdx = columnNumber;
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (!isAlphanum(nextCh)) {
-								// TODO add keyword checks here!!
-								
-								//if (isKeyword(accumulator)) {
-								//	create keyword
-								//} else {
-								//	create ident
-								//}
-								int kwInd = isKeyword(accumulator);
-								if (kwInd == -1) {
-									Token* ident = new Token(IDENT, lineNumber, accumStartIdx, accumulator);
-									tokens.push_back(*ident);
-									st = IDLE;
-									accumulator = "";
-								} else {
-									Token* kw = new Token(static_cast<tokenType>(kwInd), lineNumber, accumStartIdx, accumulator);
-									tokens.push_back(*kw);
-									st = IDLE;
-									accumulator = "";
-								}
-
-							}
-						}
-						else if (el == '!') {
-							st = SUCC_NOT;
-							std::string not_sym(1, el);
-							accumulator.append(not_sym);
-							accumStartIdx = columnNumber;
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (nextStr != "=") {
-								// lexer error
-								st = IDLE;
-								accumulator = "";
-								throw(LexerError("Symbol '!' must be followed by Symbol '='", lineNumber, columnNumber));
-							}
-						} else if (el == '<') {
-							// < is used for both relational op and for assignment
-							// needs special treatment
-							st = SUCC_LT;
-							std::string lt(1, el);
-							accumulator.append(lt);
-							accumStartIdx = columnNumber;
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if ((nextStr != "-") && (nextStr != "=")) {
-								Token* lessThan = new Token(LT, lineNumber, accumStartIdx, accumulator);
-								tokens.push_back(*lessThan);
-								st = IDLE;
-								accumulator = "";
-								accumStartIdx = 0;
-								// possibly rename to aggregator
-							}
-
-						} else if (el == '>') {
-							st = SUCC_GT;
-							std::string gt(1, el);
-							accumulator.append(gt);
-							accumStartIdx = columnNumber;
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (nextStr != "=") {
-								Token* greaterThan = new Token(GT, lineNumber, accumStartIdx, accumulator);
-								tokens.push_back(*greaterThan);
-								st = IDLE;
-								accumulator = "";
-								accumStartIdx = 0;
-							}
-						} else if (el == '=') {
-							st = SUCC_EQ;
-							std::string eq(1, el);
-							accumulator.append(eq);
-							accumStartIdx = columnNumber;
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (nextStr != "=") {
-								throw(LexerError("Symbol '=' must be followed by Symbol '='", lineNumber, columnNumber));
-							}
-						} else if (el == '/') {
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (nextStr == "*") {
-								st = IN_COMMENT;
-							} else {
-								Token* divide = new Token(DIV, lineNumber, columnNumber, "/");
-								tokens.push_back(*divide);
-							}
-						} else {
-							switch (el) {
-								// punctuation cases
-								case '(': {
-									Token* lparen = new Token(L_PAREN, lineNumber, columnNumber, "(");
-									tokens.push_back(*lparen);
-								} break;
-								case ')': {
-									Token* rparen = new Token(R_PAREN, lineNumber, columnNumber, ")");
-									tokens.push_back(*rparen);
-								} break;
-								case '{':
-								{
-									Token* lbrace = new Token(L_BRACE, lineNumber, columnNumber, "{");
-									tokens.push_back(*lbrace);
-								} break;
-								case '}': {
-									Token* rbrace = new Token(R_BRACE, lineNumber, columnNumber, "}");
-									tokens.push_back(*rbrace);
-								} break;
-								case ',': {
-									Token* comma = new Token(COMMA, lineNumber, columnNumber, ",");
-									tokens.push_back(*comma);
-								} break;
-								case ';': {
-									Token* semicolon = new Token(SEMICOLON, lineNumber, columnNumber, ";");
-									tokens.push_back(*semicolon);
-								} break;
-								case '.': {
-									Token* period = new Token(PERIOD, lineNumber, columnNumber, ".");
-									tokens.push_back(*period);
-								} break;
-							
-								// arithmetic operators
-								case '+': {
-									Token* plus = new Token(ADD, lineNumber, columnNumber, "+");
-									tokens.push_back(*plus);
-								} break;
-								case '-': {
-									Token* minus = new Token(SUB, lineNumber, columnNumber, "-");
-									tokens.push_back(*minus);
-								} break;
-								case '*': {
-									Token* multiply = new Token(MUL, lineNumber, columnNumber, "*");
-									tokens.push_back(*multiply);
-								} break;
-								//case '/': {
-								//	Token* divide = new Token(DIV, lineNumber, columnNumber, "/");
-								//	tokens.push_back(*divide);
-								//} break;
-							}
-						}
-					} break;
-					case IN_NUMBER: {
-						if (isDigit(ch)) {
-							st = IN_NUMBER;
-							std::string digit(1, el);
-							accumulator.append(digit);
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr = std::string(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (!isDigit(nextCh)) {
-								Token* number = new Token(NUMBER, lineNumber, accumStartIdx, accumulator);
-								tokens.push_back(*number);
-								st = IDLE;
-								accumulator = "";
-								accumStartIdx = 0;
-							}
-						}
-
-					} break;
-					case IN_IDENT: {
-						if (isAlphanum(ch)) {
-							st = IN_IDENT;
-							std::string alphanum(1, el);
-							accumulator.append(alphanum);
-
-							//// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr = std::string(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (!isAlphanum(nextCh)) {
-								int kwInd = isKeyword(accumulator);
-								if (kwInd == -1) {
-									Token* ident = new Token(IDENT, lineNumber, accumStartIdx, accumulator);
-									tokens.push_back(*ident);
-									st = IDLE;
-									accumulator = "";
-								}
-								else {
-									Token* kw = new Token(static_cast<tokenType>(kwInd), lineNumber, accumStartIdx, accumulator);
-									tokens.push_back(*kw);
-									st = IDLE;
-									accumulator = "";
-								}
-
-
-								//Token* ident = new Token(IDENT, lineNumber, accumStartIdx, accumulator);
-								//tokens.push_back(*ident);
-								//st = IDLE;
-								//accumulator = "";
-								//accumStartIdx = 0;
-							}
-						}
-					} break;
-					case SUCC_NOT: {
-						// check that current symbol is equal sign
-						// write accumulator
-						// set state to IDLE
-						st = SUCC_NOT;
-
-						if (str == "=") {
-							std::string eq(1, el);
-							accumulator.append(eq);
-
-							Token* notEq = new Token(NEQ, lineNumber, accumStartIdx, accumulator);
-							tokens.push_back(*notEq);
-							st = IDLE;
-							accumulator = "";
-							accumStartIdx = 0;
-						}
-					} break;
-					case SUCC_LT: {
-						st = SUCC_LT;
-
-						if (str == "-") {
-							// output assign
-							std::string dash(1, el);
-							accumulator.append(dash);
-
-							Token* assign = new Token(ASSIGN, lineNumber, accumStartIdx, accumulator);
-							tokens.push_back(*assign);
-							st = IDLE;
-							accumulator = "";
-							accumStartIdx = 0;
-
-						} else if (str == "=") {
-							// output leq
-							std::string eq(1, el);
-							accumulator.append(eq);
-
-							Token* leq = new Token(LE, lineNumber, accumStartIdx, accumulator);
-							tokens.push_back(*leq);
-							st = IDLE;
-							accumulator = "";
-							accumStartIdx = 0;
-						}
-					} break;
-					case SUCC_GT: {
-						st = SUCC_GT;
-
-						if (str == "=") {
-							std::string eq(1, el);
-							accumulator.append(eq);
-
-							Token* geq = new Token(GE, lineNumber, accumStartIdx, accumulator);
-							tokens.push_back(*geq);
-							st = IDLE;
-							accumulator = "";
-							accumStartIdx = 0;
-						}
-					} break;
-					case SUCC_EQ: {
-						st = SUCC_EQ;
-
-						if (str == "=") {
-							std::string eq(1, el);
-							accumulator.append(eq);
-
-							Token* eqeq = new Token(EQ, lineNumber, accumStartIdx, accumulator);
-							tokens.push_back(*eqeq);
-							st = IDLE;
-							accumulator = "";
-							accumStartIdx = 0;
-						}
-					} break;
-					case IN_COMMENT: {
-						st = IN_COMMENT;
-						if (str == "*") {
-
-							// lookahead
-							char nextEl = line[i + 1];
-							std::string nextStr = std::string(1, nextEl);
-							const char* nextCh = nextStr.c_str();
-
-							if (nextStr == "/") {
-								st = EXIT_COMMENT;
-							}
-						}
-					} break;
-					case EXIT_COMMENT: {
-						st = EXIT_COMMENT;
-
-						if (ch == "/") {
-							st = IDLE;
-						}
-					} break;
+void Lexer::setIncrementalSource(std::string_view text) {
+	source.copyText(text);
+	resetScan();
+	// values must survive edits to the source
+	pool.ownValues();
+	trackLines = true;
+	tokenize();
+	incrementalValid = true;
+}
+
+std::string_view Lexer::getSource() {
+	return source.text();
+}
+
+int Lexer::lineOf(size_t offset) {
+	int lineIdx = (int)(std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - lineStarts.begin()) - 1;
+	return std::max(lineIdx, 0);
+}
+
+// tokens are sorted by line, first token on lineNumber or after it
+static int firstTokenOnLine(const std::vector<Token>& tokens, int lineNumber) {
+	auto found = std::lower_bound(tokens.begin(), tokens.end(), lineNumber,
+		[](const Token& token, int ln) { return (int)token.getLineNumber() < ln; });
+	return (int)(found - tokens.begin());
+}
+
+tokenEdit Lexer::applyEdit(size_t offset, size_t removedLength, std::string_view insertText) {
+	std::string_view oldText = source.text();
+	offset = std::min(offset, oldText.size());
+	removedLength = std::min(removedLength, oldText.size() - offset);
+	size_t oldSize = oldText.size();
+	long long byteDelta = (long long)insertText.size() - (long long)removedLength;
+
+	if (!incrementalValid || lineStarts.empty()) {
+		// nothing to go on, lex everything again
+		int oldLines = (int)lineStarts.size();
+		tokenEdit all = { 0, (int)tokens.size(), 0, 1, 0 };
+		source.replaceText(offset, removedLength, insertText);
+		resetScan();
+		trackLines = true;
+		tokenize();
+		incrementalValid = true;
+		all.insertedTokens = (int)tokens.size();
+		all.lineDelta = (int)lineStarts.size() - oldLines;
+		return all;
+	}
+
+	// the edit touches lines firstLine..oldLastLine, re-lexing starts at the
+	// beginning of firstLine and goes at least to the end of the edit
+	int firstLine = lineOf(offset);
+	int oldLastLine = lineOf(offset + removedLength);
+	size_t start = lineStarts[firstLine];
+	size_t oldEnd = (oldLastLine + 1 < (int)lineStarts.size()) ? lineStarts[oldLastLine + 1] : oldSize;
+	size_t newEnd = (size_t)((long long)oldEnd + byteDelta);
+	state startState = (firstLine > 0 && lineEndsInComment[firstLine - 1]) ? IN_COMMENT : IDLE;
+
+	source.replaceText(offset, removedLength, insertText);
+	text = source.text();
+	incrementalValid = false;
+
+	Lexer relex;
+	relex.scan = scan;
+	relex.text = text.substr(start);
+	relex.lineNumber = firstLine;
+	relex.st = startState;
+	relex.trackLines = true;
+
+	// lex line by line until a line past the edit ends on an old line
+	// boundary in the same comment state, everything after it is unchanged
+	std::vector<Token> newTokens;
+	int newStop = -1;
+	int oldStop = -1;
+	size_t checked = 0;
+	Token token;
+	while (newStop < 0) {
+		bool more = relex.scanToken(token);
+		while (newStop < 0 && checked < relex.lineEndsInComment.size()) {
+			size_t lineEnd = (checked + 1 < relex.lineStarts.size()) ? relex.lineStarts[checked + 1] :
+				std::min(relex.nextLineStart, relex.text.size());
+			size_t newPos = start + lineEnd;
+			if (newPos >= newEnd) {
+				size_t oldPos = (size_t)((long long)newPos - byteDelta);
+				int oldLine = (oldPos >= oldSize) ? (int)lineStarts.size() - 1 :
+					(int)(std::lower_bound(lineStarts.begin(), lineStarts.end(), oldPos) - lineStarts.begin()) - 1;
+				if (relex.lineEndsInComment[checked] == lineEndsInComment[oldLine]) {
+					newStop = (int)checked;
+					oldStop = oldLine;
 				}
 			}
+			checked += 1;
+		}
+		if (!more) {
+			if (newStop < 0) {
+				newStop = (int)relex.lineEndsInComment.size() - 1;
+				oldStop = (int)lineStarts.size() - 1;
+			}
+			break;
+		}
+		newTokens.push_back(token);
+	}
+
+	// splice the tokens of the re-lexed lines in
+	int newLastLineNumber = firstLine + newStop + 1;
+	int lineDelta = (firstLine + newStop) - oldStop;
+	int firstToken = firstTokenOnLine(tokens, firstLine + 1);
+	int endToken = firstTokenOnLine(tokens, oldStop + 2);
+	std::vector<unsigned int> remap(relex.pool.size(), Token::NO_VALUE);
+	std::vector<Token> inserted;
+	for (const Token& t : newTokens) {
+		if ((int)t.getLineNumber() > newLastLineNumber) {
+			break;
+		}
+		unsigned int valIndex = t.getValueIndex();
+		if (valIndex != Token::NO_VALUE) {
+			if (remap[valIndex] == Token::NO_VALUE) {
+				remap[valIndex] = pool.intern(relex.pool.at(valIndex));
+			}
+			valIndex = remap[valIndex];
+		}
+		inserted.push_back(Token(t.getType(), t.getLineNumber(), t.getColumnNumber(), valIndex));
+	}
+	if (lineDelta != 0) {
+		for (size_t i = endToken; i < tokens.size(); i++) {
+			const Token& t = tokens[i];
+			tokens[i] = Token(t.getType(), t.getLineNumber() + lineDelta, t.getColumnNumber(), t.getValueIndex());
+		}
+	}
+	// most edits keep the token and line counts, those are copied in place
+	// instead of moving everything after them twice
+	if ((int)inserted.size() == endToken - firstToken) {
+		std::copy(inserted.begin(), inserted.end(), tokens.begin() + firstToken);
+	} else {
+		tokens.erase(tokens.begin() + firstToken, tokens.begin() + endToken);
+		tokens.insert(tokens.begin() + firstToken, inserted.begin(), inserted.end());
+	}
+
+	// and the line index
+	if (byteDelta != 0) {
+		for (size_t i = oldStop + 1; i < lineStarts.size(); i++) {
+			lineStarts[i] = (size_t)((long long)lineStarts[i] + byteDelta);
+		}
+	}
+	for (int i = 0; i <= newStop; i++) {
+		relex.lineStarts[i] += start;
+	}
+	if (lineDelta == 0) {
+		std::copy(relex.lineStarts.begin(), relex.lineStarts.begin() + (newStop + 1), lineStarts.begin() + firstLine);
+		std::copy(relex.lineEndsInComment.begin(), relex.lineEndsInComment.begin() + (newStop + 1), lineEndsInComment.begin() + firstLine);
+	} else {
+		lineStarts.erase(lineStarts.begin() + firstLine, lineStarts.begin() + (oldStop + 1));
+		lineEndsInComment.erase(lineEndsInComment.begin() + firstLine, lineEndsInComment.begin() + (oldStop + 1));
+		lineStarts.insert(lineStarts.begin() + firstLine, relex.lineStarts.begin(), relex.lineStarts.begin() + (newStop + 1));
+		lineEndsInComment.insert(lineEndsInComment.begin() + firstLine, relex.lineEndsInComment.begin(), relex.lineEndsInComment.begin() + (newStop + 1));
+	}
+
+	// nothing left for scanToken()
+	nextLineStart = text.size();
+	inLine = false;
+	incrementalValid = true;
+
+	tokenEdit edit = { firstToken, endToken - firstToken, (int)inserted.size(), firstLine + 1, lineDelta };
+	return edit;
+}
+
+TokenGenerator Lexer::generateTokens() {
+	Token token;
+	while (scanToken(token)) {
+		co_yield token;
+	}
+}
+
+// start TokenGenerator implementations
+
+TokenGenerator::TokenGenerator() {
+	handle = nullptr;
+}
+
+TokenGenerator::TokenGenerator(std::coroutine_handle<promise_type> h) {
+	handle = h;
+}
+
+TokenGenerator::TokenGenerator(TokenGenerator&& other) noexcept {
+	handle = other.handle;
+	other.handle = nullptr;
+}
+
+TokenGenerator& TokenGenerator::operator=(TokenGenerator&& other) noexcept {
+	if (this != &other) {
+		if (handle) {
+			handle.destroy();
+		}
+		handle = other.handle;
+		other.handle = nullptr;
+	}
+	return *this;
+}
+
+TokenGenerator::~TokenGenerator() {
+	if (handle) {
+		handle.destroy();
+	}
+}
+
+bool TokenGenerator::next() {
+	if (!handle || handle.done()) {
+		return false;
+	}
+	handle.resume();
+	return !handle.done();
+}
+
+const Token& TokenGenerator::value() const {
+	return handle.promise().current;
+}
+
+// start TokenCursor implementations
+
+TokenCursor::TokenCursor() {
+	lexer = nullptr;
+	generator = nullptr;
+	head = 0;
+	count = 0;
+	exhausted = true;
+}
+
+void TokenCursor::setLexer(Lexer* lex) {
+	lexer = lex;
+	generator = nullptr;
+	head = 0;
+	count = 0;
+	exhausted = (lex == nullptr);
+}
+
+void TokenCursor::setGenerator(TokenGenerator* gen) {
+	lexer = nullptr;
+	generator = gen;
+	head = 0;
+	count = 0;
+	exhausted = (gen == nullptr);
+}
+
+bool TokenCursor::fill(int numTokens) {
+	while (count < numTokens && !exhausted) {
+		if (generator) {
+			if (generator->next()) {
+				ring[(head + count) % LOOKAHEAD] = generator->value();
+				count += 1;
+			} else {
+				exhausted = true;
+			}
+		} else {
+			Token token;
+			if (lexer->scanToken(token)) {
+				ring[(head + count) % LOOKAHEAD] = token;
+				count += 1;
+			} else {
+				exhausted = true;
+			}
 		}
 	}
+	return count >= numTokens;
+}
+
+const Token& TokenCursor::current() {
+	return peek(0);
+}
+
+const Token& TokenCursor::peek(int ahead) {
+	// handed out when the source has no tokens at all
+	static const Token emptyInput(PERIOD, 0, 0);
+	if (fill(ahead + 1)) {
+		return ring[(head + ahead) % LOOKAHEAD];
+	}
+	if (count == 0) {
+		return emptyInput;
+	}
+	return ring[(head + count - 1) % LOOKAHEAD];
+}
+
+void TokenCursor::advance() {
+	if (fill(2)) {
+		head = (head + 1) % LOOKAHEAD;
+		count -= 1;
+	}
+}
+
+bool TokenCursor::atEnd() {
+	return !fill(2);
 }
 
 
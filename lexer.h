@@ -2,24 +2,79 @@
 #define __LEXER_H__
 
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <vector>
 #include <exception>
+#include <coroutine>
 #include "token.h"
+#include "source.h"
+#include "scan.h"
 
 
+class TokenGenerator;
+
+// what Lexer::applyEdit() did to the token vector, tokens
+// [firstToken, firstToken + removedTokens) were replaced by insertedTokens
+// new ones, and every token after them moved lineDelta lines
+struct tokenEdit {
+	int firstToken;
+	int removedTokens;
+	int insertedTokens;
+	int firstLine;
+	int lineDelta;
+};
+
 class Lexer {
 
 	public:
+		Lexer();
+		// token values are views into the lexer's source, so the lexer
+		// must stay alive for as long as its tokens are used
 		void setFile(std::string fileName);
+		void mapFile(std::string fileName);
+		// in memory source, the buffer is borrowed and must outlive the tokens
+		void setSource(std::string_view text);
+		void setSource(const char* data, size_t length);
+		// in memory source, copied so the caller's buffer can go away
+		void copySource(std::string_view text);
 		const char* lookahead(std::string& line, int& currentIndex);
 		void displayTokens();
-		std::vector<Token> getTokens();
+		const std::vector<Token>& getTokens();
+		TokenPool* getPool();
+
+		// batch mode, lexes the whole source into getTokens()
 		void tokenize();
+		// batch mode split at line boundaries over numThreads threads,
+		// produces the same tokens as tokenize()
+		void tokenizeParallel(int numThreads);
+		static int hardwareThreads();
+
+		// incremental mode, the lexer keeps its own copy of text and remembers
+		// where every line starts and whether it ends inside of a comment
+		void setIncrementalSource(std::string_view text);
+		// replaces removedLength bytes at offset with insertText and re-lexes
+		// just the lines that changed. on a LexerError the next edit lexes
+		// the whole source again
+		tokenEdit applyEdit(size_t offset, size_t removedLength, std::string_view insertText);
+		std::string_view getSource();
+		// streaming mode, lexes just far enough to produce the next token,
+		// returns false at the end of the source
+		bool scanToken(Token& token);
+		// streaming mode as a coroutine, yields one token per resume
+		TokenGenerator generateTokens();
+
+		// byte scanning kernels, the best the cpu supports by default
+		void setScanLevel(scanLevel level);
+		scanLevel getScanLevel();
+
+		// index of keyword in tokenType (LET..MAIN), -1 if not a keyword
+		static int isKeyword(std::string_view accumulator);
 
 	private:
-		std::ifstream infile;
+		SourceBuffer source;
 		std::vector<Token> tokens;
+		TokenPool pool;
+		const scanKernels* scan;
 		enum state {
 			IDLE		 = 0,
 			IN_NUMBER	 = 1,
@@ -29,15 +84,134 @@ class Lexer {
 			SUCC_GT		 = 5,
 			SUCC_EQ		 = 6,
 			IN_COMMENT   = 7,
-			EXIT_COMMENT = 8
+			EXIT_COMMENT = 8,
+			SUCC_DIV	 = 9,  // '/' seen, either DIV or start of comment
+			SUCC_STAR	 = 10, // '*' seen inside of comment
+			NUM_STATES	 = 11
+		};
+
+		// every input byte maps to one of these classes, the end of a line
+		// is fed to the dfa as CC_EOL so pending tokens get flushed
+		enum charClass {
+			CC_OTHER	 = 0,  // whitespace and unknown characters
+			CC_DIGIT	 = 1,
+			CC_LETTER	 = 2,
+			CC_NOT		 = 3,  // !
+			CC_LT		 = 4,  // <
+			CC_GT		 = 5,  // >
+			CC_EQ		 = 6,  // =
+			CC_SLASH	 = 7,  // /
+			CC_STAR		 = 8,  // *
+			CC_DASH		 = 9,  // -
+			CC_PUNCT	 = 10, // ( ) { } , ; . +
+			CC_EOL		 = 11,
+			NUM_CHAR_CLASSES = 12
+		};
+
+		enum action {
+			SKIP,		 // move to next state
+			START,		 // current char starts a multi char lexeme
+			EMIT_CHAR,	 // current char is a token on its own
+			EMIT_WITH,	 // lexeme ends with current char
+			EMIT_BEFORE, // lexeme ended on previous char, current char is reclassified from IDLE
+			FAIL		 // lexer error at start of lexeme
+		};
+
+		struct transition {
+			action act;
+			state next;
+			tokenType token;
+		};
+
+		struct dfaTables {
+			dfaTables();
+			unsigned char charClasses[256];
+			tokenType charTokens[256];
+			transition transitions[NUM_STATES][NUM_CHAR_CLASSES];
+		};
+
+		static const dfaTables& tables();
+		Token makeLexemeToken(tokenType type, int columnNumber, std::string_view value);
+
+		// scan position, kept between calls to scanToken()
+		std::string_view text;	// whole source, or one chunk of it
+		std::string_view line;	// current line, without '\n'
+		size_t nextLineStart;	// offset of the line after the current one
+		int lineNumber;
+		int column;				// index into line, line.size() is the end of line
+		int accumStartIdx;		// column number where the current lexeme started
+		state st;
+		bool inLine;
+		void resetScan();
+
+		// incremental mode, indexed by line number - 1
+		bool trackLines;
+		bool incrementalValid;
+		std::vector<size_t> lineStarts;
+		std::vector<unsigned char> lineEndsInComment;
+		int lineOf(size_t offset);
+		void lexChunk(std::string_view chunk, int firstLine, state startState);
+
+
+};
+
+// Coroutine handle for Lexer::generateTokens(). Lexer errors are rethrown
+// from next().
+class TokenGenerator {
+	public:
+		struct promise_type {
+			Token current;
+
+			TokenGenerator get_return_object() {
+				return TokenGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			std::suspend_always yield_value(const Token& token) noexcept {
+				current = token;
+				return {};
+			}
+			void return_void() {}
+			void unhandled_exception() { throw; }
 		};
-		bool isDigit(const char* ch);
-		bool isLetter(const char* ch);
-		bool isAlphanum(const char* ch);
-		bool isRelationalOpStem(const char* ch);
-		int isKeyword(std::string accumulator);
 
+		TokenGenerator();
+		TokenGenerator(TokenGenerator&& other) noexcept;
+		TokenGenerator& operator=(TokenGenerator&& other) noexcept;
+		TokenGenerator(const TokenGenerator&) = delete;
+		TokenGenerator& operator=(const TokenGenerator&) = delete;
+		~TokenGenerator();
 
+		bool next();	// resumes the lexer, false once the source is done
+		const Token& value() const;
+
+	private:
+		explicit TokenGenerator(std::coroutine_handle<promise_type> h);
+		std::coroutine_handle<promise_type> handle;
+};
+
+// Pulls tokens from a Lexer on demand. Only a small ring of lookahead
+// tokens is kept, so memory doesn't grow with the size of the source.
+class TokenCursor {
+	public:
+		static constexpr int LOOKAHEAD = 8;
+
+		TokenCursor();
+		void setLexer(Lexer* lex);
+		void setGenerator(TokenGenerator* gen);
+		const Token& current();
+		const Token& peek(int ahead);	// ahead < LOOKAHEAD, last token if past the end
+		void advance();					// stays on the last token at the end of input
+		bool atEnd();
+
+	private:
+		bool fill(int numTokens);
+		Lexer* lexer;
+		TokenGenerator* generator;	// used instead of lexer when set
+		Token ring[LOOKAHEAD];
+		int head;
+		int count;
+		bool exhausted;
 };
 
 class LexerError : virtual public std::exception {
@@ -0,0 +1,247 @@
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SCAN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only emit avx2 instructions in functions marked for it,
+// msvc allows the intrinsics anywhere
+#if defined(SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SCAN_TARGET_AVX2
+#endif
+
+static inline bool isIdentChar(unsigned char c) {
+	return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+static inline bool isDigitChar(unsigned char c) {
+	return c >= '0' && c <= '9';
+}
+
+static inline bool isWhitespaceChar(unsigned char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+// start scalar kernels
+
+static size_t spanIdentScalar(const char* p, size_t n) {
+	size_t i = 0;
+	while (i < n && isIdentChar(p[i])) {
+		i++;
+	}
+	return i;
+}
+
+static size_t spanDigitsScalar(const char* p, size_t n) {
+	size_t i = 0;
+	while (i < n && isDigitChar(p[i])) {
+		i++;
+	}
+	return i;
+}
+
+static size_t spanWhitespaceScalar(const char* p, size_t n) {
+	size_t i = 0;
+	while (i < n && isWhitespaceChar(p[i])) {
+		i++;
+	}
+	return i;
+}
+
+static size_t findCommentEndScalar(const char* p, size_t n) {
+	for (size_t i = 0; i + 1 < n; i++) {
+		if (p[i] == '*' && p[i + 1] == '/') {
+			return i;
+		}
+	}
+	return n;
+}
+
+#ifdef SCAN_X86
+
+static inline int lowestBit(unsigned int mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// start sse2 kernels, 16 bytes at a time. bytes >= 0x80 are negative as
+// signed chars so they never land inside the ascii ranges compared here
+
+static inline __m128i inRange16(__m128i v, char lo, char hi) {
+	return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+static size_t spanIdentSSE2(const char* p, size_t n) {
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+		__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+		__m128i ident = _mm_or_si128(inRange16(v, '0', '9'), inRange16(lower, 'a', 'z'));
+		unsigned int stop = ~(unsigned int)_mm_movemask_epi8(ident) & 0xFFFF;
+		if (stop) {
+			return i + lowestBit(stop);
+		}
+	}
+	return i + spanIdentScalar(p + i, n - i);
+}
+
+static size_t spanDigitsSSE2(const char* p, size_t n) {
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+		unsigned int stop = ~(unsigned int)_mm_movemask_epi8(inRange16(v, '0', '9')) & 0xFFFF;
+		if (stop) {
+			return i + lowestBit(stop);
+		}
+	}
+	return i + spanDigitsScalar(p + i, n - i);
+}
+
+static size_t spanWhitespaceSSE2(const char* p, size_t n) {
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+		__m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+		unsigned int stop = ~(unsigned int)_mm_movemask_epi8(ws) & 0xFFFF;
+		if (stop) {
+			return i + lowestBit(stop);
+		}
+	}
+	return i + spanWhitespaceScalar(p + i, n - i);
+}
+
+static size_t findCommentEndSSE2(const char* p, size_t n) {
+	size_t i = 0;
+	// the second load reads one byte further, so it needs 17 bytes
+	for (; i + 17 <= n; i += 16) {
+		__m128i star = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)), _mm_set1_epi8('*'));
+		__m128i slash = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i + 1)), _mm_set1_epi8('/'));
+		unsigned int found = (unsigned int)_mm_movemask_epi8(_mm_and_si128(star, slash));
+		if (found) {
+			return i + lowestBit(found);
+		}
+	}
+	return i + findCommentEndScalar(p + i, n - i);
+}
+
+// start avx2 kernels, 32 bytes at a time
+
+SCAN_TARGET_AVX2 static inline __m256i inRange32(__m256i v, char lo, char hi) {
+	return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+SCAN_TARGET_AVX2 static size_t spanIdentAVX2(const char* p, size_t n) {
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+		__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+		__m256i ident = _mm256_or_si256(inRange32(v, '0', '9'), inRange32(lower, 'a', 'z'));
+		unsigned int stop = ~(unsigned int)_mm256_movemask_epi8(ident);
+		if (stop) {
+			return i + lowestBit(stop);
+		}
+	}
+	return i + spanIdentScalar(p + i, n - i);
+}
+
+SCAN_TARGET_AVX2 static size_t spanDigitsAVX2(const char* p, size_t n) {
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+		unsigned int stop = ~(unsigned int)_mm256_movemask_epi8(inRange32(v, '0', '9'));
+		if (stop) {
+			return i + lowestBit(stop);
+		}
+	}
+	return i + spanDigitsScalar(p + i, n - i);
+}
+
+SCAN_TARGET_AVX2 static size_t spanWhitespaceAVX2(const char* p, size_t n) {
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+		__m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+		unsigned int stop = ~(unsigned int)_mm256_movemask_epi8(ws);
+		if (stop) {
+			return i + lowestBit(stop);
+		}
+	}
+	return i + spanWhitespaceScalar(p + i, n - i);
+}
+
+SCAN_TARGET_AVX2 static size_t findCommentEndAVX2(const char* p, size_t n) {
+	size_t i = 0;
+	for (; i + 33 <= n; i += 32) {
+		__m256i star = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + i)), _mm256_set1_epi8('*'));
+		__m256i slash = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + i + 1)), _mm256_set1_epi8('/'));
+		unsigned int found = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(star, slash));
+		if (found) {
+			return i + lowestBit(found);
+		}
+	}
+	return i + findCommentEndScalar(p + i, n - i);
+}
+
+#endif
+
+static const scanKernels kernelTable[] = {
+	{ SCAN_SCALAR, "scalar", spanIdentScalar, spanDigitsScalar, spanWhitespaceScalar, findCommentEndScalar },
+#ifdef SCAN_X86
+	{ SCAN_SSE2, "sse2", spanIdentSSE2, spanDigitsSSE2, spanWhitespaceSSE2, findCommentEndSSE2 },
+	{ SCAN_AVX2, "avx2", spanIdentAVX2, spanDigitsAVX2, spanWhitespaceAVX2, findCommentEndAVX2 },
+#endif
+};
+
+static scanLevel queryScanLevel() {
+#if defined(SCAN_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool sse2 = (info[3] & (1 << 26)) != 0;
+	// avx needs the os to save the ymm registers as well
+	bool avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+	bool avx2 = false;
+	if (avx && maxLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+	return avx2 ? SCAN_AVX2 : (sse2 ? SCAN_SSE2 : SCAN_SCALAR);
+#elif defined(SCAN_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return SCAN_AVX2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return SCAN_SSE2;
+	}
+	return SCAN_SCALAR;
+#else
+	return SCAN_SCALAR;
+#endif
+}
+
+scanLevel detectScanLevel() {
+	static const scanLevel level = queryScanLevel();
+	return level;
+}
+
+const scanKernels& getScanKernels(scanLevel level) {
+	if (level > detectScanLevel()) {
+		level = detectScanLevel();
+	}
+	return kernelTable[level];
+}
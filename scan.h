@@ -0,0 +1,29 @@
+#ifndef __SCAN_H__
+#define __SCAN_H__
+
+#include <cstddef>
+
+// Byte scanning kernels used by the lexer to skip over the inside of
+// identifiers, numbers, whitespace and comments without running the dfa
+// on every character. Each kernel looks at p[0..n) only.
+enum scanLevel {
+	SCAN_SCALAR = 0,
+	SCAN_SSE2	= 1,
+	SCAN_AVX2	= 2
+};
+
+struct scanKernels {
+	scanLevel level;
+	const char* name;
+	size_t (*spanIdent)(const char* p, size_t n);		// leading [A-Za-z0-9]
+	size_t (*spanDigits)(const char* p, size_t n);		// leading [0-9]
+	size_t (*spanWhitespace)(const char* p, size_t n);	// leading ' ', '\t', '\r'
+	size_t (*findCommentEnd)(const char* p, size_t n);	// index of "*/", n if none
+};
+
+// best level the cpu supports, detected once
+scanLevel detectScanLevel();
+// kernels for level, falls back to a lower level the cpu supports
+const scanKernels& getScanKernels(scanLevel level);
+
+#endif
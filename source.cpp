@@ -0,0 +1,168 @@
+#include "source.h"
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::SourceBuffer() {
+	loaded = false;
+	data = nullptr;
+	size = 0;
+	mapping = nullptr;
+#ifdef _WIN32
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+#endif
+}
+
+SourceBuffer::~SourceBuffer() {
+	release();
+}
+
+bool SourceBuffer::readFile(std::string fileName) {
+	release();
+	std::ifstream infile(fileName, std::ios::binary);
+	if (!infile.is_open()) {
+		return false;
+	}
+	std::stringstream buffer;
+	buffer << infile.rdbuf();
+	contents = buffer.str();
+	data = contents.data();
+	size = contents.size();
+	loaded = true;
+	return true;
+}
+
+bool SourceBuffer::setText(std::string_view text) {
+	release();
+	data = text.data();
+	size = text.size();
+	loaded = true;
+	return true;
+}
+
+bool SourceBuffer::copyText(std::string_view text) {
+	release();
+	contents = std::string(text);
+	data = contents.data();
+	size = contents.size();
+	loaded = true;
+	return true;
+}
+
+void SourceBuffer::replaceText(size_t offset, size_t count, std::string_view text) {
+	contents.replace(offset, count, text);
+	data = contents.data();
+	size = contents.size();
+}
+
+bool SourceBuffer::isOwned() {
+	return loaded && mapping == nullptr && data == contents.data();
+}
+
+bool SourceBuffer::mapFile(std::string fileName) {
+	release();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	loaded = true;
+	if (fileSize.QuadPart == 0) {
+		// empty files can't be mapped, nothing to lex anyway
+		return true;
+	}
+	HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (fileMapping == nullptr) {
+		release();
+		return false;
+	}
+	mappingHandle = fileMapping;
+	mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	if (mapping == nullptr) {
+		release();
+		return false;
+	}
+	data = static_cast<const char*>(mapping);
+	size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return false;
+	}
+	loaded = true;
+	if (st.st_size > 0) {
+		void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED) {
+			close(fd);
+			loaded = false;
+			return false;
+		}
+		madvise(addr, st.st_size, MADV_SEQUENTIAL);
+		mapping = addr;
+		data = static_cast<const char*>(addr);
+		size = st.st_size;
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+#endif
+	return true;
+}
+
+void SourceBuffer::release() {
+#ifdef _WIN32
+	if (mapping != nullptr) {
+		UnmapViewOfFile(mapping);
+	}
+	if (mappingHandle != nullptr) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != nullptr) {
+		CloseHandle(fileHandle);
+	}
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (mapping != nullptr) {
+		munmap(mapping, size);
+	}
+#endif
+	mapping = nullptr;
+	contents = std::string();
+	data = nullptr;
+	size = 0;
+	loaded = false;
+}
+
+bool SourceBuffer::isLoaded() {
+	return loaded;
+}
+
+bool SourceBuffer::isMapped() {
+	return mapping != nullptr;
+}
+
+std::string_view SourceBuffer::text() {
+	return std::string_view(data, size);
+}
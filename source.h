@@ -0,0 +1,45 @@
+#ifndef __SOURCE_H__
+#define __SOURCE_H__
+
+#include <string>
+#include <string_view>
+
+// Holds the bytes of a source file for the whole compilation. Tokens keep
+// std::string_views into this buffer, so it must outlive every token
+// produced from it.
+class SourceBuffer {
+	public:
+		SourceBuffer();
+		~SourceBuffer();
+		SourceBuffer(const SourceBuffer&) = delete;
+		SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+		bool readFile(std::string fileName);	// copies file into memory
+		bool mapFile(std::string fileName);		// memory maps file, read only
+		bool setText(std::string_view text);	// borrows text, caller keeps it alive
+		bool copyText(std::string_view text);	// copies text into memory
+		// edits text loaded with readFile or copyText
+		void replaceText(size_t offset, size_t count, std::string_view text);
+		bool isOwned();
+		void release();
+
+		bool isLoaded();
+		bool isMapped();
+		std::string_view text();
+
+	private:
+		bool loaded;
+		const char* data;
+		size_t size;
+
+		std::string contents; // backing storage when read with readFile
+
+		// mapping handles
+		void* mapping;
+#ifdef _WIN32
+		void* fileHandle;
+		void* mappingHandle;
+#endif
+};
+
+#endif
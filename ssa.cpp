@@ -1,29 +1,59 @@
 #include "ssa.h"
 #include "token.h"
-#include <stdexcept>
 #include <iostream>
 #include <string>
 #include <set>
-#include <queue>
 #include <stack>
+#include <algorithm>
 
 // ssa value class
 
+static const char* opcodeEnumStrings[28] = {
+	"NEG",
+	"ADDOP",
+	"SUBOP",
+	"MULOP",
+	"DIVOP",
+	"CMP",
+	"ADDA",
+	"LOAD",
+	"STORE",
+	"PHI",
+	"END",
+	"BRA",
+	"BNE",
+	"BEQ",
+	"BLE",
+	"BLT",
+	"BGE",
+	"BGT",
+	"CONST",
+	"NOP",
+	"read",
+	"write",
+	"writeNL",
+	"argAssign",
+	"call",
+	"return",
+	"move",
+	"moveConst"
+};
+
 std::string SSAValue::getTextForEnum(int enumVal) {
 	return opcodeEnumStrings[enumVal];
 }
 
 std::string SSAValue::formatOperand(SSAValue* operand) {
-	if (operand->op == NOP && operand->label != "") {
-		return "(" + operand->label + ")";
+	if (operand->op == NOP && operand->info->label != "") {
+		return "(" + operand->info->label + ")";
 	} else {
 		return "(" + std::to_string(operand->id) + ")";
 	}
 }
 
 std::string SSAValue::formatRegOperand(SSAValue* operand) {
-	if (operand->regNum != 0) {
-		return "(R" + std::to_string(operand->regNum) + ")";
+	if (operand->info->regNum != 0) {
+		return "(R" + std::to_string(operand->info->regNum) + ")";
 	} else {
 		return formatOperand(operand);
 	}
@@ -31,21 +61,21 @@ std::string SSAValue::formatRegOperand(SSAValue* operand) {
 
 std::string SSAValue::callRepr() {
 	std::string output;
-	if (regNum != 0) {
-		output = "R" + std::to_string(regNum) + "= call " + argName + "(";
+	if (info->regNum != 0) {
+		output = "R" + std::to_string(info->regNum) + "= call " + info->argName + "(";
 	} else {
 
-		output = std::to_string(id) + ": call " + argName + "(";
+		output = std::to_string(id) + ": call " + info->argName + "(";
 	}
-	for (int i = 0; i < formalParams.size(); i++) {
-		SSAValue* callArg = callArgs.at(i);
+	for (int i = 0; i < info->formalParams.size(); i++) {
+		SSAValue* callArg = info->callArgs.at(i);
 		std::string id;
-		if (callArg->regNum != 0) {
-			id = "R" + std::to_string(callArg->regNum);
+		if (callArg->info->regNum != 0) {
+			id = "R" + std::to_string(callArg->info->regNum);
 		} else {
 			id = std::to_string(callArg->id);
 		}
-		output += formalParams.at(i) + " : (" + id + "), ";
+		output += info->formalParams.at(i) + " : (" + id + "), ";
 	}
 	output.pop_back();
 	output.pop_back();
@@ -55,21 +85,21 @@ std::string SSAValue::callRepr() {
 
 
 std::string SSAValue::moveRepr() {
-	std::string output = "MOVE R" + std::to_string(regToMoveFrom) + ", R" + std::to_string(regToMoveTo);
+	std::string output = "MOVE R" + std::to_string(info->regToMoveFrom) + ", R" + std::to_string(info->regToMoveTo);
 	return output;
 }
 
 std::string SSAValue::moveConstRepr() {
-	std::string output = "MOVE #" + std::to_string(operand1->constValue) + ", R" + std::to_string(regToMoveTo);
+	std::string output = "MOVE #" + std::to_string(operand1->info->constValue) + ", R" + std::to_string(info->regToMoveTo);
 	return output;
 }
 void SSAValue::instRepr() {
 	if (op == call) {
 		std::cout << callRepr() << std::endl;
 	} else if (op == argAssign) {
-		std::cout << id << ": arg " << argName << std::endl;
+		std::cout << id << ": arg " << info->argName << std::endl;
 	} else if (op == CONST) {
-		std::cout << id << ": CONST #" << constValue << std::endl;
+		std::cout << id << ": CONST #" << info->constValue << std::endl;
 	} else if (op == BRA || op == write || op == ret) {
 		std::cout << id << ": " << getTextForEnum(op) << formatOperand(operand1) << std::endl;
 	} else if (op == NOP || op == read || op == writeNL) {
@@ -81,30 +111,30 @@ void SSAValue::instRepr() {
 
 
 std::string SSAValue::getNameType() {
-	std::string info = "; ";
+	std::string names = "; ";
 	if (operand1 != nullptr) {
-		info += "lArg: " + op1Name;
+		names += "lArg: " + info->op1Name;
 	}
 	if (operand2 != nullptr) {
-		info += ", rArg: " + op2Name;
+		names += ", rArg: " + info->op2Name;
 	}
-	return info;
+	return names;
 }
 
 void SSAValue::instReprWNames() {
 	if (op == call) {
 		std::cout << callRepr() << std::endl;
 	} else if (op == argAssign) {
-		std::cout << id << ": arg " << argName << std::endl;
+		std::cout << id << ": arg " << info->argName << std::endl;
 	} else if (op == CONST) {
-		std::cout << id << ": CONST #" << constValue << getNameType() << std::endl;
+		std::cout << id << ": CONST #" << info->constValue << getNameType() << std::endl;
 	} else if (op == BRA || op == write || op == ret) {
 		std::cout << id << ": " << getTextForEnum(op) << formatOperand(operand1) << getNameType() << std::endl;
 	} else if (op == NOP || op == read || op == writeNL) {
 		std::cout << id << ": " << getTextForEnum(op) << getNameType() << std::endl;
 	} else {
-		if (prevDomWithOpcode != nullptr) {
-			std::cout << id << ": " << getTextForEnum(op) << formatOperand(operand1) << formatOperand(operand2) << getNameType() << ", " << prevDomWithOpcode->instCFGRepr() << std::endl;
+		if (info->prevDomWithOpcode != nullptr) {
+			std::cout << id << ": " << getTextForEnum(op) << formatOperand(operand1) << formatOperand(operand2) << getNameType() << ", " << info->prevDomWithOpcode->instCFGRepr() << std::endl;
 		} else {
 			std::cout << id << ": " << getTextForEnum(op) << formatOperand(operand1) << formatOperand(operand2) << getNameType() << ", " << "No Dom Inst with Opcode" << std::endl;
 		}
@@ -113,10 +143,10 @@ void SSAValue::instReprWNames() {
 
 std::string SSAValue::elimRepr() {
 	return std::to_string(id) + ": \\<eliminated by " +
-		std::to_string(eliminatedBy->id) + ": " +
-		getTextForEnum(eliminatedBy->op) +
-		formatOperand(eliminatedBy->operand1) +
-		formatOperand(eliminatedBy->operand2) + "\\>";
+		std::to_string(info->eliminatedBy->id) + ": " +
+		getTextForEnum(info->eliminatedBy->op) +
+		formatOperand(info->eliminatedBy->operand1) +
+		formatOperand(info->eliminatedBy->operand2) + "\\>";
 }
 
 
@@ -125,11 +155,11 @@ std::string SSAValue::instCFGRepr() {
 	if (op == call) {
 		output = callRepr();
 	} else if (op == argAssign) {
-		output = std::to_string(id) + ": arg " + argName;
+		output = std::to_string(id) + ": arg " + info->argName;
 	} else if (eliminated) {
 		output = elimRepr();
 	} else if (op == CONST) {
-		output = std::to_string(id) + ": CONST #" + std::to_string(constValue);
+		output = std::to_string(id) + ": CONST #" + std::to_string(info->constValue);
 	} else if (op == BRA || op == write || op == ret) {
 		output = std::to_string(id) + ": " + getTextForEnum(op) + formatOperand(operand1);
 	} else if (op == NOP || op == read || op == writeNL) {
@@ -153,22 +183,22 @@ std::string SSAValue::instCFGRegRepr() {
 	} else if (op == call) {
 		output = callRepr();
 	} else if (op == argAssign) {
-		output = "R" + std::to_string(regNum) + "= arg " + argName;
+		output = "R" + std::to_string(info->regNum) + "= arg " + info->argName;
 	} else if (eliminated) {
 		output = elimRepr();
 	} else if (op == CONST) {
-		output = std::to_string(id) + ": CONST #" + std::to_string(constValue);
+		output = std::to_string(id) + ": CONST #" + std::to_string(info->constValue);
 	} else if (op == BRA || op == write || op == ret) {
 		output = getTextForEnum(op) + formatRegOperand(operand1);
 	} else if (op == NOP || op == writeNL) {
-		output = label + ":";
+		output = info->label + ":";
 	} else if (op == read) {
-		output = "R" + std::to_string(regNum) + "= " + getTextForEnum(op);
+		output = "R" + std::to_string(info->regNum) + "= " + getTextForEnum(op);
 	} else {
 		if (op >= BNE && op <= BGT) {
 			output = std::to_string(id) + ": " + getTextForEnum(op) + formatRegOperand(operand1) + formatRegOperand(operand2);
 		} else {
-			output = "R" + std::to_string(regNum) + "= " + getTextForEnum(op) + formatRegOperand(operand1) + formatRegOperand(operand2);
+			output = "R" + std::to_string(info->regNum) + "= " + getTextForEnum(op) + formatRegOperand(operand1) + formatRegOperand(operand2);
 		}
 
 	}
@@ -176,8 +206,8 @@ std::string SSAValue::instCFGRegRepr() {
 }
 
 void SSAValue::setOpNames(std::string operand1Name, std::string operand2Name) {
-	op1Name = operand1Name;
-	op2Name = operand2Name;
+	info->op1Name = operand1Name;
+	info->op2Name = operand2Name;
 }
 
 // ssa class
@@ -206,54 +236,51 @@ SSAValue* SSA::SSACreate(opcode operation, SSAValue* x, SSAValue* y) {
 	//	// then search up the linked list looking for an inst that has same params
 		prevDomWithOpcode = findPrevDomWithOpcode(operation);
 
-		SSAValue* iter = prevDomWithOpcode;
-		while (iter != nullptr) {
-			if (!inWhile && iter->operand1 == x && iter->operand2 == y) {
-
-				// found common subexpression
-				elimBy = iter;
-			}
-			iter = iter->prevDomWithOpcode;
+		auto found = valueNumbers.find({ operation, x, y });
+		if (found != valueNumbers.end()) {
+			// found common subexpression
+			elimBy = found->second;
 		}
 
 	}
-	SSAValue* result = new SSAValue();
+	SSAValue* result = newValue();
 	result->id = maxID++;
 	result->op = operation;
 	result->operand1 = x;
 	result->operand2 = y;
-	result->prevDomWithOpcode = prevDomWithOpcode;
+	result->info->prevDomWithOpcode = prevDomWithOpcode;
 	addSSAValue(result);
 	addInOrder(result);
 	if (elimBy != nullptr) {
 		result->eliminated = true;
-		result->eliminatedBy = elimBy;
+		result->info->eliminatedBy = elimBy;
 		return elimBy;
 	}
+	trackUses(result);
 	return result;
 
 }
 
 SSAValue* SSA::SSACreateMove(int currentReg, int moveToReg) {
-	SSAValue* moveInstr = new SSAValue();
+	SSAValue* moveInstr = newValue();
 	moveInstr->id = maxID++;
 	moveInstr->op = move;
-	moveInstr->regToMoveFrom = currentReg;
-	moveInstr->regToMoveTo = moveToReg;
+	moveInstr->info->regToMoveFrom = currentReg;
+	moveInstr->info->regToMoveTo = moveToReg;
 	return moveInstr;
 	
 }
 
 SSAValue* SSA::SSACreateConstMove(SSAValue* constInstr, int moveToReg) {
-	SSAValue* moveInstr = new SSAValue();
+	SSAValue* moveInstr = newValue();
 	moveInstr->id = maxID++;
 	moveInstr->op = moveConst;
 	moveInstr->operand1 = constInstr;
-	moveInstr->regToMoveTo = moveToReg;
+	moveInstr->info->regToMoveTo = moveToReg;
 	return moveInstr;
 }
 SSAValue* SSA::SSACreateWhilePhi(SSAValue* x, SSAValue* y) {
-	SSAValue* result = new SSAValue();
+	SSAValue* result = newValue();
 	result->id = maxID++;
 	result->op = PHI;
 	result->operand1 = x;
@@ -263,45 +290,47 @@ SSAValue* SSA::SSACreateWhilePhi(SSAValue* x, SSAValue* y) {
 }
 
 SSAValue* SSA::SSACreate(opcode operation, SSAValue* y) {
-	SSAValue* result = new SSAValue();
+	SSAValue* result = newValue();
 	result->id = maxID++;
 	result->op = operation;
 	result->operand1 = y;
 	addInOrder(result);
 	addSSAValue(result);
+	trackUses(result);
 	return result;
 }
 
 SSAValue* SSA::SSACreateArgAssign(std::string argName) {
-	SSAValue* result = new SSAValue();
+	SSAValue* result = newValue();
 	result->id = maxID++;
 	result->op = argAssign;
-	result->argName = argName;
+	result->info->argName = argName;
 	addInOrder(result);
 	addSSAValue(result);
 	return result;
 }
 
 SSAValue* SSA::SSACreateCall(std::string funcName, std::vector<SSAValue*> cArgs, std::vector<std::string> fParams) {
-	SSAValue* result = new SSAValue();
+	SSAValue* result = newValue();
 	result->id = maxID++;
 	result->op = call;
-	result->argName = funcName;
-	result->callArgs = cArgs;
-	result->formalParams = fParams;
+	result->info->argName = funcName;
+	result->info->callArgs = cArgs;
+	result->info->formalParams = fParams;
 	addInOrder(result);
 	addSSAValue(result);
+	trackUses(result);
 	return result;
 }
 
 SSAValue* SSA::SSACreateConst(int constVal) {
 	SSAValue* val = findConst(constVal);
 	if (val == nullptr) {
-		SSAValue* ssaConst = new SSAValue();
+		SSAValue* ssaConst = newValue();
 		ssaConst->op = CONST;
 		numConsts += 1;
 		ssaConst->id = -numConsts;
-		ssaConst->constValue = constVal;
+		ssaConst->info->constValue = constVal;
 		addInOrder(ssaConst);
 		addConst(constVal, ssaConst);
 		addSSAConst(ssaConst);
@@ -311,7 +340,7 @@ SSAValue* SSA::SSACreateConst(int constVal) {
 }
 
 SSAValue* SSA::SSACreateNop() {
-	SSAValue* result = new SSAValue();
+	SSAValue* result = newValue();
 	result->op = NOP;
 	return result;
 }
@@ -325,32 +354,37 @@ void SSA::updateNop(SSAValue* nopInst) {
 
 }	
 
-void SSA::addInOrder(SSAValue* newInst) {
-	inOrder.back().push_back(newInst);
+size_t valueKeyHash::operator()(const valueKey& key) const {
+	size_t h = std::hash<SSAValue*>()(key.operand1);
+	h ^= std::hash<SSAValue*>()(key.operand2) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	h ^= (size_t)key.op + 0x9e3779b9 + (h << 6) + (h >> 2);
+	return h;
 }
 
-SSAValue* SSA::findPrevDomWithOpcode(opcode operation) {
-	// find previous dominating instruction with same opcode
-	for (int i = inOrder.size() - 1; i >= 0; i--) {
+void SSA::addInOrder(SSAValue* newInst) {
+	// arithmetic instructions become visible to cse until their scope exits
+	opcode operation = newInst->op;
+	if (operation < ADDOP || operation > DIVOP) {
+		return;
+	}
+	latestWithOpcodeLog.push_back(std::make_tuple(operation, latestWithOpcode[operation]));
+	latestWithOpcode[operation] = newInst;
 
-		std::vector<SSAValue*> inner = inOrder.at(i);
-		for (int j = inner.size() - 1; j >= 0; j--) {
-			SSAValue* item = inner.at(j);
-			if (item->op == operation) {
-				return item;
-			}
-		}
+	// an older instruction with the same operands keeps the key, it is the
+	// one later duplicates get eliminated by
+	valueKey key = { operation, newInst->operand1, newInst->operand2 };
+	if (valueNumbers.insert({ key, newInst }).second) {
+		valueNumberLog.push_back(key);
 	}
-	return nullptr;
-}
-void SSA::setInWhile(bool value) {
-	inWhile = value;
 }
 
-bool SSA::getInWhile() {
-	return inWhile;
+SSAValue* SSA::findPrevDomWithOpcode(opcode operation) {
+	// find previous dominating instruction with same opcode
+	if (operation < ADDOP || operation > DIVOP) {
+		return nullptr;
+	}
+	return latestWithOpcode[operation];
 }
-
 int SSA::getTailID() {
 	return instTail->id;
 }
@@ -365,14 +399,20 @@ void SSA::setInstTail(SSAValue* newTail) {
 
 SSA::SSA(std::string fName) {
 	funcName = fName;
+	bbListHead = nullptr;
+	instList = nullptr;
+	iGraphNodeID = 0;
 	maxID = 0;
 	numConsts = 0;
-	maxBlockID = 0;
 	instListLength = 0;
-	instTail = new SSAValue();
+	instTail = newValue();
 	scopeDepth = 0;
+	bits = &getBitsetKernels(detectScanLevel());
+	for (int i = 0; i <= DIVOP; i++) {
+		latestWithOpcode[i] = nullptr;
+	}
 	createContext();
-	constBlock = new BasicBlock();
+	constBlock = arena.blocks.create();
 	constBlock->funcName = funcName;
 	constBlock->id = -1;
 	//basicBlocks.push_back(context);
@@ -380,6 +420,36 @@ SSA::SSA(std::string fName) {
 }
 
 
+SSA::~SSA() {
+	// every value, block, node and register goes with the arena
+}
+
+SSAValue* SSA::newValue() {
+	SSAValue* val = arena.values.create();
+	val->info = arena.infos.create();
+	return val;
+}
+
+SSAValue* SSA::allocSSAValue() {
+	return newValue();
+}
+
+BasicBlock* SSA::allocBasicBlock() {
+	return arena.blocks.create();
+}
+
+const SSAArena& SSA::getArena() {
+	return arena;
+}
+
+size_t SSAArena::objectCount() const {
+	return values.size() + infos.size() + blocks.size() + nodes.size() + registers.size();
+}
+
+size_t SSAArena::blockCount() const {
+	return values.blockCount() + infos.blockCount() + blocks.blockCount() + nodes.blockCount() + registers.blockCount();
+}
+
 void SSA::addSSAValue(SSAValue* newSSAVal) {
 	if (instListLength == 0) {
 		instList = newSSAVal;
@@ -411,55 +481,227 @@ void SSA::addSSAConst(SSAValue* newSSAVal) {
 // symbolTable functions
 
 void SSA::enterScope() {
-	symTable.push_back(std::unordered_map<std::string, SSAValue*>());
-	symTableCopy.push_back(std::unordered_map<std::string, SSAValue*>());
-
-	inOrder.push_back(std::vector<SSAValue*>());
+	scopeMarks.push_back({ valueNumberLog.size(), latestWithOpcodeLog.size(), symbolLog.size() });
 
 	scopeDepth = scopeDepth + 1;
 }
 
-std::unordered_map<std::string, SSAValue*> SSA::exitScope() {
-	std::unordered_map<std::string, SSAValue*> lastScope = symTable.back();
-	symTable.pop_back();
-	inOrder.pop_back();
+void SSA::exitScope(std::vector<scopeDef>& assigned) {
+	scopeMark mark = scopeMarks.back();
+	scopeMarks.pop_back();
+
+	// a variable is logged once per scope, so the log already is the list
+	// of variables assigned in this scope. then undo the assignments
+	// newest first
+	for (size_t i = mark.symbols; i < symbolLog.size(); i++) {
+		int var = symbolLog[i].var;
+		assigned.push_back({ var, currentDef[var] });
+	}
+	while (symbolLog.size() > mark.symbols) {
+		symbolUndo undo = symbolLog.back();
+		currentDef[undo.var] = undo.prevDef;
+		defScope[undo.var] = undo.prevScope;
+		symbolLog.pop_back();
+	}
+
+	// same for the cse entries
+	while (valueNumberLog.size() > mark.valueNumbers) {
+		valueNumbers.erase(valueNumberLog.back());
+		valueNumberLog.pop_back();
+	}
+	while (latestWithOpcodeLog.size() > mark.latestWithOpcode) {
+		latestWithOpcode[std::get<0>(latestWithOpcodeLog.back())] = std::get<1>(latestWithOpcodeLog.back());
+		latestWithOpcodeLog.pop_back();
+	}
 
 	scopeDepth = scopeDepth - 1;
-	return lastScope;
 }
 
-void SSA::addSymbol(std::string name, SSAValue* val) {
-	if (checkVarDeclList(name)) {
-		symTable.back().insert_or_assign(name, val);
-		symTableCopy.back().insert_or_assign(name, val);
+void SSA::addSymbol(const std::string& name, SSAValue* val) {
+	int var = findVar(name);
+	if (var != -1) {
+		addSymbol(var, val);
 	} else {
 		std::cout << "Parser Error: Var Decl not found for " << name << std::endl;
 	}
 }
 
-SSAValue* SSA::findSymbol(std::string name) {
-	if (checkVarDeclList(name)) {
-		for (int i = symTable.size() - 1; i >= 0; i--) {
-			std::unordered_map<std::string, SSAValue*> scopeMap = symTable[i];
+void SSA::addSymbol(int var, SSAValue* val) {
+	if (defScope[var] != scopeDepth) {
+		symbolLog.push_back({ var, currentDef[var], defScope[var] });
+		defScope[var] = scopeDepth;
+	}
+	currentDef[var] = val;
+}
 
-			try {
-				SSAValue* val = scopeMap.at(name);
-				return val;
-			}
-			catch (std::out_of_range& oor) {
-				// intentionally left blank
-			}
-		}
-		// if variable is not defined when attempting access
-		//	set var value to 0
-		SSAValue* constZero = SSACreateConst(0);
-		return constZero;
+SSAValue* SSA::findSymbol(const std::string& name) {
+	int var = findVar(name);
+	if (var != -1) {
+		return findSymbol(var);
 	} else {
 		std::cout << "Parser Error: Var Decl not found for " << name << std::endl;
 		return nullptr;
 	}
+}
+
+SSAValue* SSA::findSymbol(int var) {
+	// last assigned before the innermost loop, so it's that loop's phi
+	if (!loops.empty() && defScope[var] < loops.back().bodyDepth) {
+		return findLoopPhi(loops.size() - 1, var);
+	}
+	if (currentDef[var] != nullptr) {
+		return currentDef[var];
+	}
+	// if variable is not defined when attempting access
+	//	set var value to 0
+	SSAValue* constZero = SSACreateConst(0);
+	return constZero;
+}
+
+// while loop functions
+
+void SSA::enterLoop() {
+	openLoop loop;
+	loop.bodyDepth = scopeDepth + 1;
+	loops.push_back(loop);
+}
+
+SSAValue* SSA::findLoopPhi(size_t loop, int var) {
+	auto found = loops[loop].phis.find(var);
+	if (found != loops[loop].phis.end()) {
+		return found->second;
+	}
+	// no id and not in the instruction list until SSACreateLoopPhi
+	SSAValue* phi = newValue();
+	phi->op = PHI;
+	phi->operand1 = valueBeforeLoop(loop, var);
+	trackUses(phi);
+	phi->pending = true;
+	pendingValues.push_back(phi);
+	loops[loop].phis.insert({ var, phi });
+	loops[loop].phiOrder.push_back(var);
+	return phi;
+}
+
+SSAValue* SSA::valueBeforeLoop(size_t loop, int var) {
+	// from before the enclosing loop as well
+	if (loop > 0 && defScope[var] < loops[loop - 1].bodyDepth) {
+		return findLoopPhi(loop - 1, var);
+	}
+	if (currentDef[var] != nullptr) {
+		return currentDef[var];
+	}
+	return SSACreateConst(0);
+}
+
+SSAValue* SSA::SSACreateLoopPhi(int var, SSAValue* bodyValue) {
+	auto found = loops.back().phis.find(var);
+	if (found == loops.back().phis.end()) {
+		// assigned in the body without being read first
+		SSAValue* phi = newValue();
+		phi->op = PHI;
+		phi->operand1 = valueBeforeLoop(loops.size() - 1, var);
+		phi->operand2 = bodyValue;
+		phi->id = maxID++;
+		addSSAValue(phi);
+		trackUses(phi);
+		loops.back().phis.insert({ var, phi });
+		return phi;
+	}
+	SSAValue* phi = found->second;
+	phi->pending = false;
+	// "let x <- x" leaves the phi itself as the body's value
+	phi->operand2 = (bodyValue == phi) ? phi->operand1 : bodyValue;
+	phi->id = maxID++;
+	addSSAValue(phi);
+	if (phi->operand2->pending) {
+		pendingUses[phi->operand2].push_back({ phi, 1 });
+	}
+	return phi;
+}
+
+void SSA::exitLoop() {
+	openLoop loop = std::move(loops.back());
+	loops.pop_back();
+
+	// the body never assigned these, so the phi is the value from before
+	// the loop in all of its uses
+	for (int var : loop.phiOrder) {
+		SSAValue* phi = loop.phis.at(var);
+		if (phi->operand2 == nullptr) {
+			replaceValue(phi, phi->operand1);
+		}
+	}
+
+	// nothing can be replaced anymore once the outermost loop is done
+	if (loops.empty()) {
+		for (SSAValue* val : pendingValues) {
+			val->pending = false;
+		}
+		pendingValues.clear();
+		pendingUses.clear();
+	}
+}
+
+void SSA::trackUses(SSAValue* val) {
+	if (loops.empty()) {
+		return;
+	}
+	bool usesPending = false;
+	if (val->operand1 != nullptr && val->operand1->pending) {
+		pendingUses[val->operand1].push_back({ val, 0 });
+		usesPending = true;
+	}
+	if (val->operand2 != nullptr && val->operand2->pending) {
+		pendingUses[val->operand2].push_back({ val, 1 });
+		usesPending = true;
+	}
+	for (int i = 0; i < (int)val->info->callArgs.size(); i++) {
+		if (val->info->callArgs[i] != nullptr && val->info->callArgs[i]->pending) {
+			pendingUses[val->info->callArgs[i]].push_back({ val, 2 + i });
+		}
+	}
+	// arithmetic on a pending value can turn into a common subexpression
+	// once the value is replaced
+	if (usesPending && val->op >= ADDOP && val->op <= DIVOP) {
+		val->pending = true;
+		pendingValues.push_back(val);
+	}
+}
 
+void SSA::replaceValue(SSAValue* val, SSAValue* with) {
+	auto found = pendingUses.find(val);
+	if (found == pendingUses.end()) {
+		return;
+	}
+	std::vector<operandUse> uses = std::move(found->second);
+	pendingUses.erase(found);
+	val->pending = false;
+
+	for (operandUse use : uses) {
+		SSAValue* user = use.user;
+		if (use.slot == 0) {
+			user->operand1 = with;
+		} else if (use.slot == 1) {
+			user->operand2 = with;
+		} else {
+			user->info->callArgs[use.slot - 2] = with;
+		}
+		if (with->pending) {
+			pendingUses[with].push_back(use);
+		}
 
+		// the visible cse entries are from scopes around the loop, the
+		// id check keeps out header instructions after user
+		if (user->op >= ADDOP && user->op <= DIVOP && !user->eliminated) {
+			auto same = valueNumbers.find({ user->op, user->operand1, user->operand2 });
+			if (same != valueNumbers.end() && same->second != user && same->second->id < user->id) {
+				user->eliminated = true;
+				user->info->eliminatedBy = same->second;
+				replaceValue(user, same->second);
+			}
+		}
+	}
 }
 
 // constTable functions
@@ -470,29 +712,44 @@ void SSA::addConst(int constVal, SSAValue* constSSAVal) {
 }
 
 SSAValue* SSA::findConst(int constVal) {
-
-	try {
-		SSAValue* val = constTable.at(constVal);
-		return val;
-	} catch (std::out_of_range& oor) {
+	auto found = constTable.find(constVal);
+	if (found == constTable.end()) {
 		return nullptr;
 	}
-
+	return found->second;
 }
 
 
 // var decl functions
-void SSA::addToVarDecl(std::string varName) {
+int SSA::addToVarDecl(const std::string& varName) {
 	varDeclList.push_back(varName);
+	auto inserted = varIDs.insert({ varName, (int)varNames.size() });
+	if (inserted.second) {
+		varNames.push_back(varName);
+		currentDef.push_back(nullptr);
+		defScope.push_back(0);
+	}
+	return inserted.first->second;
 }
 
-bool SSA::checkVarDeclList(std::string varName) {
-	for (std::string var : varDeclList) {
-		if (var == varName) {
-			return true;
-		}
+bool SSA::checkVarDeclList(const std::string& varName) {
+	return findVar(varName) != -1;
+}
+
+int SSA::findVar(const std::string& varName) {
+	auto found = varIDs.find(varName);
+	if (found == varIDs.end()) {
+		return -1;
 	}
-	return false;
+	return found->second;
+}
+
+int SSA::varCount() {
+	return (int)varNames.size();
+}
+
+const std::string& SSA::getVarName(int var) {
+	return varNames[var];
 }
 // ssa debugging functions
 
@@ -537,9 +794,9 @@ void SSA::printSSA() {
 
 void SSA::printSymTable() {
 	std::cout << "Symbol       ID       Scope" << std::endl;
-	for (int i = 0; i < symTableCopy.size(); i++) {
-		for (auto kv : symTableCopy[i]) {
-			std::cout << kv.first << "            (" << kv.second->id << ")      "<< i << std::endl;
+	for (int var = 0; var < varNames.size(); var++) {
+		if (currentDef[var] != nullptr) {
+			std::cout << varNames[var] << "            (" << currentDef[var]->id << ")      " << defScope[var] << std::endl;
 		}
 	}
 
@@ -561,14 +818,16 @@ void SSA::printVarDeclList() {
 
 std::string SSA::reprBasicBlocks(BasicBlock* head, bool printRegs) {
 
-	if (constBlock->fallThrough == nullptr) {
+	if (constBlock->succ[EDGE_FT] == nullptr) {
 		connectFT(constBlock, bbListHead);
-		basicBlocks.push_back(constBlock);
 	}
 	std::string out_string;
 	for (BasicBlock* bb : basicBlocks) {
 		out_string += bb->bbRepr(printRegs) + "\n";
 	}
+	// the const block has id -1, it is kept out of basicBlocks so ids stay
+	// indexes into it
+	out_string += constBlock->bbRepr(printRegs) + "\n";
 	return out_string;
 }
 
@@ -580,14 +839,13 @@ void SSA::gen(bool printRegs) {
 }
 
 BasicBlock* SSA::createContext() {
-	BasicBlock* newBlock = new BasicBlock();
-	newBlock->id = maxBlockID++;
+	BasicBlock* newBlock = arena.blocks.create();
+	addBlock(newBlock);
 	if (bbListHead == nullptr) {
 		bbListHead = newBlock;
 	}
 	newBlock->funcName = funcName;
 	context = newBlock;
-	basicBlocks.push_back(context);
 	return newBlock;
 }
 
@@ -608,7 +866,7 @@ void SSA::addInstToBB(SSAValue* inst) {
 
 		}
 	}
-	inst->containingBB = context;
+	inst->info->containingBB = context;
 }
 
 void SSA::addInstToConstBB(SSAValue* inst) {
@@ -621,28 +879,28 @@ void SSA::addInstToConstBB(SSAValue* inst) {
 
 void SSA::connectFT(BasicBlock* from, BasicBlock* to) {
 
-	if (context->fallThrough != nullptr) {
+	if (context->succ[EDGE_FT] != nullptr) {
 	}
-	if (from->fallThrough == nullptr) {
+	if (from->succ[EDGE_FT] == nullptr) {
 
-		from->fallThrough = to;
-		to->fallThroughFrom = from;
+		from->succ[EDGE_FT] = to;
+		to->pred[EDGE_FT] = from;
 	}
 }
 
 void SSA::connectBR(BasicBlock* from, BasicBlock* to) {
-	if (context->branch != nullptr) {
+	if (context->succ[EDGE_BR] != nullptr) {
 
 	}
-	if (from != nullptr && from->branch == nullptr) {
-		from->branch = to;
-		to->branchFrom = from;
+	if (from != nullptr && from->succ[EDGE_BR] == nullptr) {
+		from->succ[EDGE_BR] = to;
+		to->pred[EDGE_BR] = from;
 	}
 }
 
 void SSA::connectLoop(BasicBlock* from, BasicBlock* to) {
-	from->loop = to;
-	to->loopBackFrom = from;
+	from->succ[EDGE_LOOP] = to;
+	to->pred[EDGE_LOOP] = from;
 }
 
 BasicBlock* SSA::getContext() {
@@ -656,18 +914,21 @@ void SSA::setContext(BasicBlock* ctx, bool addToHead) {
 }
 
 BasicBlock* SSA::createBlock() {
-	BasicBlock* bb = new BasicBlock();
+	BasicBlock* bb = arena.blocks.create();
 	bb->funcName = funcName;
 	return bb;
 }
-void SSA::setJoinType(BasicBlock* block, std::string type) {
+void SSA::setJoinType(BasicBlock* block, blockJoin type) {
 	block->joinType = type;
 }
 
 void SSA::initBlock(BasicBlock* blockToInit) {
-	blockToInit->id = maxBlockID++;
-	basicBlocks.push_back(blockToInit);
+	addBlock(blockToInit);
+}
 
+void SSA::addBlock(BasicBlock* bb) {
+	bb->id = (int)basicBlocks.size();
+	basicBlocks.push_back(bb);
 }
 
 
@@ -713,27 +974,27 @@ std::string BasicBlock::bbRepr(bool printRegs) {
 	}
 	bbString.pop_back();
 	bbString = bbString + "}\"];";
-	if (fallThrough != nullptr) {
+	if (succ[EDGE_FT] != nullptr) {
 		std::string fromIDStr = std::to_string(id);
 		std::string type = "FT";
 		if (id == -1) {
 			fromIDStr = "CONST";
 			type = "";
 		}
-		std::string toIDStr = std::to_string(fallThrough->id);
+		std::string toIDStr = std::to_string(succ[EDGE_FT]->id);
 
 		std::string out = funcName + fromIDStr + ":s -> " + funcName + toIDStr + ":n [label=\"" + type + "\"];";
 		bbString += "\n" + out;
 	}
-	if (branch != nullptr) {
+	if (succ[EDGE_BR] != nullptr) {
 		std::string fromIDStr = std::to_string(id);
-		std::string toIDStr = std::to_string(branch->id);
+		std::string toIDStr = std::to_string(succ[EDGE_BR]->id);
 		std::string out = funcName + fromIDStr + ":s -> " + funcName + toIDStr + ":n [label=\"" + "BR" + "\"];";
 		bbString += "\n" + out;
 	}
-	if (loop != nullptr) {
+	if (succ[EDGE_LOOP] != nullptr) {
 		std::string fromIDStr = std::to_string(id);
-		std::string toIDStr = std::to_string(loop->id);
+		std::string toIDStr = std::to_string(succ[EDGE_LOOP]->id);
 		std::string out = funcName + fromIDStr + ":s -> " + funcName + toIDStr + ":n [label=\"" + "BRLoop" + "\"];";
 		bbString += "\n" + out;
 	}
@@ -755,134 +1016,38 @@ void SSA::reset() {
 
 	scopeDepth = 0;
 
-	symTable = std::vector<std::unordered_map<std::string, SSAValue*>>();
-	symTableCopy = std::vector<std::unordered_map<std::string, SSAValue*>>();
+	for (int var = 0; var < varNames.size(); var++) {
+		currentDef[var] = nullptr;
+		defScope[var] = 0;
+	}
+	symbolLog.clear();
 
-	inOrder = std::vector<std::vector<SSAValue*>>();
+	valueNumbers.clear();
+	valueNumberLog.clear();
+	latestWithOpcodeLog.clear();
+	scopeMarks.clear();
+	for (int i = 0; i <= DIVOP; i++) {
+		latestWithOpcode[i] = nullptr;
+	}
 
+	loops.clear();
+	pendingUses.clear();
+	pendingValues.clear();
+	dominators.clear();
+	interference.clear();
 }
 
 
 
-void SSA::generateLiveRanges(BasicBlock* bb, std::set<SSAValue*>& liveRanges, std::vector<SSAValue*>& phis, SSAValue* instTail, SSAValue* stopAt) {
-
-	SSAValue* iter = instTail;
-	bool nopEncountered = false;
-	int nopEncounteredCount = 0;
-	while (iter != stopAt && iter->op != CONST) {
-		
-		if (iter->op == PHI) {
-			phis.push_back(iter);
-		}
-		if (iter->op == NOP) {
-			nopEncountered = true;
-			nopEncounteredCount += 1;
-		}
-		if (nopEncountered && bb->joinType == "while" && bb->numVisits == 1) {
-			// above the phi instructions in while join block
-			break;
-		} else if (nopEncountered && bb->joinType == "while" && bb->numVisits == 2 && nopEncounteredCount == 1) {
-			for (SSAValue* phi : phis) {
-				liveRanges.insert(phi->operand1);
-			}
-			phis = std::vector<SSAValue*>();
-			nopEncountered = false;
-
-		}
-		bool deadCode = false;
-		if (liveRanges.find(iter) != liveRanges.end()) {
-			liveRanges.erase(iter);
-		} else {
-			if ( (iter->op >= BRA && iter->op <= BGT) || 
-				 (iter->op == write) || (iter->op == writeNL) || (iter->op == ret) ){
-
-			} else {
-				deadCode = true;
-			}
-		}
-		if ((iter->op < BRA || iter->op > NOP) && !iter->isVoidCall) {
-			if (deadCode) {
-				iter->deadCode = deadCode;
-			}
-
-			std::set<SSAValue*> iGraphSet;
-			try {
-				iGraphSet = iGraph.at(iter);
-			} catch (std::out_of_range& oor) {
-				iGraphSet = std::set<SSAValue*>();
-			}
-
-			for (SSAValue* lrVal : liveRanges) {
-				iGraphSet.insert(lrVal);
-
-			}
-			if (!iter->deadCode) {
-				iGraph.insert({ iter, iGraphSet });
-			}
-
-		}
-		if (iter->op == call) {
-			for (SSAValue* callArg : iter->callArgs) {
-				if (callArg->op != CONST) {
-					liveRanges.insert(callArg);
-				}
-			}
-		} else if (iter->op == PHI) {
-			// do nothing
-		} else {
-			if (iter->operand1 != nullptr && iter->operand1->op != CONST) {
-				if (iter->operand1->op != NOP) {
-					liveRanges.insert(iter->operand1);
-
-				}
-			}
-			if (iter->operand2 != nullptr && iter->operand2->op != CONST) {
-				if (iter->operand2->op != NOP) {
-					liveRanges.insert(iter->operand2);
-
-				}
-			}
-
-		}
-		iter = iter->prev;
-	}
-}
-
 void SSA::printLiveRanges() {
 	std::cout << "digraph iGraph {" << std::endl;
-	std::set<SSAValue*> labelsCreated;
-	std::vector<std::tuple<int, int>> madeEdges;
-	for (auto kv : iGraph) {
-		std::string id = std::to_string(kv.first->id);
-		std::string output;
-		if (!kv.first->deadCode) {
-			if (labelsCreated.find(kv.first) == labelsCreated.end()) {
-				output = id + "[label=\"" + kv.first->instCFGRepr() + "\"]\n";
-			}
-			labelsCreated.insert(kv.first);
-		} else {
-			output = id + "[style=filled fillcolor=\"red\" label=\"" + kv.first->instCFGRepr() + " - DEAD\"]\n";
-		}
-		
-		for (SSAValue* interElem : kv.second) {
-			bool addEdge = true;
-			for (auto tup : madeEdges) {
-				if ( (std::get<0>(tup) == kv.first->id && std::get<1>(tup) == interElem->id)
-					or (std::get<0>(tup) == interElem->id && std::get<0>(tup) == kv.first->id)) {
-					addEdge = false;
-				}
-			}
-			if (addEdge) {
-				if (labelsCreated.find(interElem) == labelsCreated.end()) {
-					output += std::to_string(interElem->id) + "[label=\"" + interElem->instCFGRepr() + "\"]\n";
-					labelsCreated.insert(interElem);
-				}
-				output += id + " -> " + std::to_string(interElem->id) + " [arrowhead=none]\n";
-				std::tuple<int, int> newTup1 = std::make_tuple(kv.first->id, interElem->id);
-				std::tuple<int, int> newTup2 = std::make_tuple(interElem->id, kv.first->id);
-				madeEdges.push_back(newTup1);
-				madeEdges.push_back(newTup2);
-
+	for (int node = 0; node < interference.size(); node++) {
+		SSAValue* val = interference.values[node];
+		std::string id = std::to_string(val->id);
+		std::string output = id + "[label=\"" + val->instCFGRepr() + "\"]\n";
+		for (int other : interference.neighbors(node)) {
+			if (other > node) {
+				output += id + " -> " + std::to_string(interference.values[other]->id) + " [arrowhead=none]\n";
 			}
 		}
 		std::cout << output << std::endl;
@@ -902,107 +1067,35 @@ bool elemExistsInStack(std::stack<BasicBlock*> stackCopy, BasicBlock* toFind) {
 }
 
 
-void SSA::traverseBasicBlocks(BasicBlock* startBlock) {
-	std::queue<BasicBlock*> q;
-	q.push(startBlock);
-	while (q.size() != 0) {
-
-		BasicBlock* currentBlock = q.front();
-		q.pop();
-		if (!currentBlock->visited) {
-			handleTraverseStep(currentBlock);
-		}
-		if (! (currentBlock->joinType == "while") && !(currentBlock->splitType == "if") ) {
-			currentBlock->visited = true;
-		} 
-		startBlock->visited = true;
-		if (currentBlock->joinType == "while") {
-			if (currentBlock->numVisits == 1) {
-
-				q.push(currentBlock->loopBackFrom);
-				currentBlock->numVisits = 1;
-				currentBlock->loopBackFrom->numVisits += 1;
-			} else if (currentBlock->numVisits == 2) {
-				BasicBlock* ftBlock = currentBlock->fallThroughFrom;
-				BasicBlock* brBlock = currentBlock->branchFrom;
-				if (ftBlock != nullptr && ftBlock->id != -1) {
-					q.push(ftBlock);
-					ftBlock->numVisits += 1;
-				} if (brBlock != nullptr && brBlock->id != -1) {
-					q.push(brBlock);
-					brBlock->numVisits += 1;
-				}
-				currentBlock->numVisits += 1;
-				currentBlock->visited = true;
-
-			}
-		} else if (currentBlock->splitType == "if") {
-			if (currentBlock->numVisits == 2) {
-				BasicBlock* ftBlock = currentBlock->fallThroughFrom;
-				BasicBlock* brBlock = currentBlock->branchFrom;
-				if (ftBlock != nullptr && ftBlock->id != -1) {
-
-					q.push(ftBlock);
-					ftBlock->numVisits += 1;
-				} if (brBlock != nullptr && brBlock->id != -1) {
-					q.push(brBlock);
-					brBlock->numVisits += 1;
-				}
-				currentBlock->numVisits += 1;
-				currentBlock->visited = true;
-
-
-			}
-
-		} else {
-			BasicBlock* ftBlock = currentBlock->fallThroughFrom;
-			BasicBlock* brBlock = currentBlock->branchFrom;
-
-
-			if (ftBlock != nullptr && ftBlock->joinType == "while" && ftBlock->numVisits == 1) {
-				q.push(ftBlock);
-				ftBlock->numVisits += 1;
-			} else if (ftBlock != nullptr && !ftBlock->visited && ftBlock->id != -1) {
-
-				q.push(ftBlock);
-				ftBlock->numVisits += 1;
-			}
-			if (brBlock != nullptr && !brBlock->visited && brBlock->id != -1) {
-				q.push(brBlock);
-				brBlock->numVisits += 1;
-
-			}
-		}
-	}
-
-}
-
+// one pass over the blocks. a block that falls through has to fall
+// through to the next id, and ids index basicBlocks, so that block is
+// looked up directly
 void SSA::correctBasicBlockIssues() {
 	for (BasicBlock* bb : basicBlocks) {
 		if (bb->tail != nullptr && bb->tail->op == BRA) {
-			BasicBlock* nextBlock = bb->fallThrough;
+			BasicBlock* nextBlock = bb->succ[EDGE_FT];
 
 			if (nextBlock != nullptr) {
-				bb->fallThrough = nullptr;
-				bb->branch = nextBlock;
-				nextBlock->branchFrom = bb;
+				bb->succ[EDGE_FT] = nullptr;
+				bb->succ[EDGE_BR] = nextBlock;
+				nextBlock->pred[EDGE_BR] = bb;
 			}
 		}
-		if (bb->fallThrough != nullptr && bb->fallThrough->id != bb->id + 1) {
+		if (bb->succ[EDGE_FT] != nullptr && bb->succ[EDGE_FT]->id != bb->id + 1) {
 			BasicBlock* correctBlock = findBBWithID(bb->id + 1);
-			bb->fallThrough = correctBlock;
-			correctBlock->fallThroughFrom = bb;
+			bb->succ[EDGE_FT] = correctBlock;
+			if (correctBlock != nullptr) {
+				correctBlock->pred[EDGE_FT] = bb;
+			}
 		}
 	}
 }
 
 BasicBlock* SSA::findBBWithID(int id) {
-	for (BasicBlock* bb : basicBlocks) {
-		if (bb->id == id) {
-			return bb;
-		}
+	if (id < 0 || id >= (int)basicBlocks.size()) {
+		return nullptr;
 	}
-	return nullptr;
+	return basicBlocks[id];
 }
 
 BasicBlock* SSA::getBBListHead() {
@@ -1013,315 +1106,579 @@ BasicBlock* SSA::getBBTail() {
 	return context;
 }
 
-void BasicBlock::unionLiveRanges(BasicBlock* toUnionFrom, std::string sideOfPhi) {
-	if (toUnionFrom != nullptr) {
-		for (SSAValue* val : toUnionFrom->liveRanges) {
-			liveRanges.insert(val);
-		}
-		for (SSAValue* phi : toUnionFrom->phis) {
-			if (sideOfPhi == "left") {
-				if (phi->operand1->op != CONST) {
-					liveRanges.insert(phi->operand1);
-				}
-			} else if (sideOfPhi == "right") {
-				if (phi->operand2->op != CONST) {
-					liveRanges.insert(phi->operand2);
-				}
-			} else {
-				// blank for now
-			}
-		}
-	}
+void SSA::computeDominators() {
+	dominators.compute(basicBlocks, bbListHead);
 }
 
-void SSA::handleTraverseStep(BasicBlock* bb) {
+const DominatorTree& SSA::getDominators() {
+	return dominators;
+}
 
-	if (bb->conditionalBlockType == "ifThenElse-Else") {
-		if (bb->branch == nullptr && bb->loop == nullptr) {
-			// at the end of else in if-then-else struct
-			bb->unionLiveRanges(bb->fallThrough, "right");
-		} else {
-			bb->unionLiveRanges(bb->fallThrough, "left");
-			bb->unionLiveRanges(bb->branch, "right");
-		}
-	} else if (bb->conditionalBlockType == "ifThenElse-Then") {
-		if (bb->fallThrough == nullptr && bb->loop == nullptr) {
-			// at the end of then in if-then-else struct
-			bb->unionLiveRanges(bb->branch, "left");
-		} else {
-			bb->unionLiveRanges(bb->fallThrough, "left");
-			bb->unionLiveRanges(bb->branch, "right");
-		}
+// liveness functions
 
-	} else if (bb->conditionalBlockType == "ifThen-Then") {
-		if (bb->branch == nullptr && bb->loop == nullptr) {
-			// at the end of then in if-then struct
-			bb->unionLiveRanges(bb->fallThrough, "left");
-		} else {
-			bb->unionLiveRanges(bb->fallThrough, "");
-			bb->unionLiveRanges(bb->branch, "right");
-		}
-	} else {
-		if (bb->loop != nullptr) {
-			// end of while body struct
-			bb->unionLiveRanges(bb->loop, "right");
-		} else {
-			// need to handle cond with only then block here
-			if (bb->splitType == "if") {
-				if (bb->branch->joinType == "while") {
-					if (bb->fallThrough->conditionalBlockType == "ifThen-Then") {
+void SSA::setBitsetLevel(scanLevel level) {
+	bits = &getBitsetKernels(level);
+}
 
-						bb->unionLiveRanges(bb->branch, "right");
+scanLevel SSA::getBitsetLevel() {
+	return bits->level;
+}
 
-					} else {
-						bb->unionLiveRanges(bb->branch, "left");
+const InterferenceGraph& SSA::getInterference() {
+	return interference;
+}
 
-					}
-				} else {
-					bb->unionLiveRanges(bb->branch, "right");
+// a straight run of instructions. a while header is cut in two at the nop
+// its loop edge jumps back to, the part above runs once and the part below
+// on every iteration
+typedef struct {
+	SSAValue* first;
+	SSAValue* last;
+	BasicBlock* block;
+	bool loopHeader;
+} liveSegment;
 
-				}
-			} else {
-				bb->unionLiveRanges(bb->branch, "");
+// dense index of a value, -1 for constants and values no longer in the
+// instruction list
+static inline int liveIndexOf(const std::vector<SSAValue*>& values, SSAValue* v) {
+	if (v == nullptr || v->op == CONST || v->op == NOP || v->info == nullptr) {
+		return -1;
+	}
+	int index = v->info->liveIndex;
+	if (index < 0 || index >= (int)values.size() || values[index] != v) {
+		return -1;
+	}
+	return index;
+}
 
+// calls the function with the index of every value an instruction reads.
+// phis read theirs on the edges coming in, not here
+template <typename F>
+static void forEachUse(const std::vector<SSAValue*>& values, SSAValue* inst, F f) {
+	if (inst->op == call) {
+		for (SSAValue* callArg : inst->info->callArgs) {
+			int index = liveIndexOf(values, callArg);
+			if (index >= 0) {
+				f(index);
 			}
-
-			bb->unionLiveRanges(bb->fallThrough, "");
-			bb->unionLiveRanges(bb->loop, "");
-
+		}
+	} else if (inst->op != PHI) {
+		int index = liveIndexOf(values, inst->operand1);
+		if (index >= 0) {
+			f(index);
+		}
+		index = liveIndexOf(values, inst->operand2);
+		if (index >= 0) {
+			f(index);
 		}
 	}
+}
 
-
-	SSAValue* stopAt; 
-	if (bb->head != nullptr) {
-		stopAt = bb->head->prev;
-	} else {
-		stopAt = nullptr;
+// backward dataflow over dense value indices. values read outside the
+// segment that defines them get a bit in every segment's live in, which is
+// iterated to a fixed point sweeping the segments in postorder (reverse
+// postorder of the reversed cfg) and only revisiting those whose
+// successors changed. a phi's operand is live out of the predecessor it
+// comes from: for a loop phi the loop edge gives operand2, for an if the
+// blocks dominated by the then block give operand1. the last walk over
+// each segment adds an edge between every value and what is live across
+// it, and marks values nothing reads as dead code
+void SSA::computeLiveness() {
+	interference.clear();
+	int numBlocks = (int)basicBlocks.size();
+	if (instList == nullptr || numBlocks == 0) {
+		return;
 	}
-	generateLiveRanges(bb, bb->liveRanges, bb->phis, bb->tail, stopAt);
 
-}
+	computeDominators();
 
-IGraphNode* SSA::findInIGraphNodes(SSAValue* toFind) {
-	for (IGraphNode* node : iGraphNodes) {
-		if (node->initValue == toFind) {
-			return node;
+	// cut blocks into segments
+	std::vector<BasicBlock*> loopFrom(numBlocks, nullptr);
+	for (BasicBlock* bb : basicBlocks) {
+		BasicBlock* header = bb->succ[EDGE_LOOP];
+		if (header != nullptr && header->id >= 0 && header->id < numBlocks) {
+			loopFrom[header->id] = bb;
 		}
 	}
-	return nullptr;
-}
-
-IGraphNode::IGraphNode(SSAValue* val, int nodeID) {
-	initValue = val;
-	values.insert(val);
-	id = nodeID;
-	moveTarget = nullptr;
-	visited = false;
-	color = -1;
-}
-
-void SSA::generateIGraphNodes() {
-	for (auto kv : iGraph) {
-		IGraphNode* node = findInIGraphNodes(kv.first);
-		if (node == nullptr) {
-			node = new IGraphNode(kv.first, kv.first->id);
-			iGraphNodes.push_back(node);
-
-			for (SSAValue* val : kv.second) {
-				IGraphNode* connectToNode = findInIGraphNodes(val);
-				if (connectToNode == nullptr) {
-					connectToNode = new IGraphNode(val, val->id);
-					iGraphNodes.push_back(connectToNode);
-				}
+	std::vector<liveSegment> segments;
+	std::vector<int> firstSegment(numBlocks);
+	std::vector<int> loopSegment(numBlocks, -1);
+	for (BasicBlock* bb : basicBlocks) {
+		firstSegment[bb->id] = (int)segments.size();
+		SSAValue* head = bb->tail != nullptr ? bb->head : nullptr;
+		SSAValue* tail = head != nullptr ? bb->tail : nullptr;
+		SSAValue* loopNop = head;
+		if (loopFrom[bb->id] != nullptr) {
+			SSAValue* bra = loopFrom[bb->id]->tail;
+			if (bra != nullptr && bra->op == BRA && bra->operand1 != nullptr && bra->operand1->op == NOP) {
+				loopNop = bra->operand1;
 			}
 		}
+		if (loopFrom[bb->id] != nullptr && loopNop != head && head != nullptr) {
+			segments.push_back({ head, loopNop->prev, bb, false });
+			loopSegment[bb->id] = (int)segments.size();
+			segments.push_back({ loopNop, tail, bb, true });
+		} else {
+			if (loopFrom[bb->id] != nullptr) {
+				loopSegment[bb->id] = (int)segments.size();
+			}
+			segments.push_back({ head, tail, bb, loopFrom[bb->id] != nullptr });
+		}
 	}
-	for (auto kv : iGraph) {
-		IGraphNode* node = findInIGraphNodes(kv.first);
-		std::vector<IGraphNode*> toErase;
-		for (SSAValue* connectedToVal : kv.second) {
-			IGraphNode* connectToNode = findInIGraphNodes(connectedToVal);
-
-			bool erased = false;
-			if (node->initValue->deadCode) {
-				toErase.push_back(node);
-				erased = true;
+	int numSegments = (int)segments.size();
+	auto lastSegment = [&](BasicBlock* bb) {
+		return loopSegment[bb->id] >= 0 ? loopSegment[bb->id] : firstSegment[bb->id];
+	};
+	auto forEachInSegment = [&](int seg, auto f) {
+		for (SSAValue* iter = segments[seg].first; iter != nullptr; iter = iter->next) {
+			f(iter);
+			if (iter == segments[seg].last) {
+				break;
 			}
-			if (connectToNode != nullptr && connectToNode->initValue->deadCode) {
-				toErase.push_back(connectToNode);
-				erased = true;
+		}
+	};
+
+	// values are numbered segment by segment, so each segment's own values
+	// sit next to each other
+	std::vector<SSAValue*> values;
+	std::vector<int> defSegment;
+	auto number = [&](SSAValue* v, int seg) {
+		int index = v->info->liveIndex;
+		if (v->op != CONST && (index < 0 || index >= (int)values.size() || values[index] != v)) {
+			v->info->liveIndex = (int)values.size();
+			values.push_back(v);
+			defSegment.push_back(seg);
+		}
+	};
+	std::vector<int> segmentValues(numSegments + 1);
+	for (int seg = 0; seg < numSegments; seg++) {
+		segmentValues[seg] = (int)values.size();
+		forEachInSegment(seg, [&](SSAValue* iter) { number(iter, seg); });
+	}
+	segmentValues[numSegments] = (int)values.size();
+	for (SSAValue* iter = instList; iter != nullptr; iter = iter->next) {
+		number(iter, -1);
+	}
+
+	// edges between segments, with the phi operands each one carries
+	std::vector<std::pair<int, int>> edges;
+	for (int seg = 0; seg < numSegments; seg++) {
+		BasicBlock* bb = segments[seg].block;
+		if (seg + 1 < numSegments && segments[seg + 1].block == bb) {
+			edges.push_back({ seg, seg + 1 });
+			continue;
+		}
+		size_t edgesFrom = edges.size();
+		for (int kind = 0; kind < NUM_EDGE_KINDS; kind++) {
+			BasicBlock* to = bb->succ[kind];
+			if (to == nullptr || to->id < 0 || to->id >= numBlocks || basicBlocks[to->id] != to) {
+				continue;
 			}
-			if (!erased) {
-				if (connectToNode != nullptr) {
-					node->connectedTo.insert(connectToNode);
-					connectToNode->connectedTo.insert(node);
-
+			int target = (kind == EDGE_LOOP && loopSegment[to->id] >= 0) ? loopSegment[to->id] : firstSegment[to->id];
+			if (std::find(edges.begin() + edgesFrom, edges.end(), std::make_pair(seg, target)) == edges.end()) {
+				edges.push_back({ seg, target });
+			}
+		}
+	}
+	std::vector<int> succStart(numSegments + 1, 0);
+	std::vector<int> predStart(numSegments + 1, 0);
+	for (auto& edge : edges) {
+		succStart[edge.first + 1]++;
+		predStart[edge.second + 1]++;
+	}
+	for (int seg = 0; seg < numSegments; seg++) {
+		succStart[seg + 1] += succStart[seg];
+		predStart[seg + 1] += predStart[seg];
+	}
+	// edges are already grouped by source
+	std::vector<int> succs(edges.size());
+	std::vector<int> preds(edges.size());
+	std::vector<int> phiUseStart(edges.size() + 1, 0);
+	std::vector<int> phiUses;
+	std::vector<int> predFill(predStart.begin(), predStart.end() - 1);
+	for (size_t e = 0; e < edges.size(); e++) {
+		int from = edges[e].first;
+		int to = edges[e].second;
+		succs[e] = to;
+		preds[predFill[to]++] = from;
+
+		phiUseStart[e] = (int)phiUses.size();
+		const liveSegment& target = segments[to];
+		bool leftSide;
+		if (target.loopHeader) {
+			BasicBlock* loopSource = loopFrom[target.block->id];
+			leftSide = !(loopSource != nullptr && lastSegment(loopSource) == from);
+		} else {
+			BasicBlock* split = dominators.immediateDominator(target.block);
+			BasicBlock* thenBlock = split != nullptr ? split->succ[EDGE_FT] : nullptr;
+			int thenIndex = dominators.indexOf(thenBlock);
+			leftSide = thenIndex >= 0 && dominators.dominates(thenIndex, dominators.indexOf(segments[from].block));
+		}
+		forEachInSegment(to, [&](SSAValue* iter) {
+			if (iter->op == PHI) {
+				int index = liveIndexOf(values, leftSide ? iter->operand1 : iter->operand2);
+				if (index >= 0) {
+					phiUses.push_back(index);
 				}
 			}
-
+		});
+	}
+	phiUseStart[edges.size()] = (int)phiUses.size();
+
+	// values read outside their segment, numbered in value order so the
+	// ones a segment defines are a range of bits. a use of one of them in
+	// any other segment is live on entry there, SSA puts uses in the
+	// defining segment after the definition
+	std::vector<char> isGlobal(values.size(), 0);
+	std::vector<int> useStart(numSegments + 1, 0);
+	std::vector<int> segmentUses;
+	for (int seg = 0; seg < numSegments; seg++) {
+		useStart[seg] = (int)segmentUses.size();
+		forEachInSegment(seg, [&](SSAValue* iter) {
+			forEachUse(values, iter, [&](int use) {
+				if (defSegment[use] != seg) {
+					isGlobal[use] = 1;
+					segmentUses.push_back(use);
+				}
+			});
+		});
+	}
+	useStart[numSegments] = (int)segmentUses.size();
+	for (int use : phiUses) {
+		isGlobal[use] = 1;
+	}
+	std::vector<int> globalIndex(values.size(), -1);
+	std::vector<int> globals;
+	std::vector<int> segmentGlobals(numSegments + 1, 0);
+	for (int index = 0; index < (int)values.size(); index++) {
+		if (isGlobal[index]) {
+			globalIndex[index] = (int)globals.size();
+			globals.push_back(index);
+		}
+	}
+	for (int seg = 0; seg <= numSegments; seg++) {
+		segmentGlobals[seg] = (int)(std::lower_bound(globals.begin(), globals.end(), segmentValues[seg]) - globals.begin());
+	}
+	for (int& use : segmentUses) {
+		use = globalIndex[use];
+	}
+	for (int& use : phiUses) {
+		use = globalIndex[use];
+	}
+
+	// live in only ever grows, so besides its bits each segment keeps the
+	// range of words that can be non zero and the sweeps stay inside it.
+	// live out is gathered again from the successors whenever it's needed
+	size_t words = bitsetWords(globals.size());
+	std::vector<uint64_t> liveIn(numSegments * words, 0);
+	std::vector<std::pair<size_t, size_t>> inWords(numSegments, { words, 0 });
+	auto widen = [](std::pair<size_t, size_t>& range, size_t first, size_t end) {
+		range.first = std::min(range.first, first);
+		range.second = std::max(range.second, end);
+	};
+	// the union of the successors' live in and the phi operands on the
+	// edges to them, into out which must be zero in the range returned
+	auto gatherLiveOut = [&](int seg, uint64_t* out) {
+		std::pair<size_t, size_t> range = { words, 0 };
+		for (int e = succStart[seg]; e < succStart[seg + 1]; e++) {
+			std::pair<size_t, size_t> succWords = inWords[succs[e]];
+			if (succWords.first < succWords.second) {
+				const uint64_t* succIn = liveIn.data() + succs[e] * words;
+				bits->unionWith(out + succWords.first, succIn + succWords.first, succWords.second - succWords.first);
+				widen(range, succWords.first, succWords.second);
+			}
+			for (int u = phiUseStart[e]; u < phiUseStart[e + 1]; u++) {
+				setBit(out, phiUses[u]);
+				widen(range, phiUses[u] / BITSET_WORD_BITS, phiUses[u] / BITSET_WORD_BITS + 1);
+			}
 		}
-		for (auto needToErase : toErase) {
-			int index = findIndexOfIGraphNode(needToErase);
-			if (index >= 0) {
-				iGraphNodes.erase(iGraphNodes.begin() + index);
-
+		return range;
+	};
+	for (int seg = 0; seg < numSegments; seg++) {
+		for (int u = useStart[seg]; u < useStart[seg + 1]; u++) {
+			setBit(liveIn.data() + seg * words, segmentUses[u]);
+			widen(inWords[seg], segmentUses[u] / BITSET_WORD_BITS, segmentUses[u] / BITSET_WORD_BITS + 1);
+		}
+	}
+
+	// postorder from the entry, segments it can't reach go last
+	std::vector<int> order;
+	std::vector<char> seen(numSegments, 0);
+	std::vector<std::pair<int, int>> stack;
+	int entry = firstSegment[bbListHead->id];
+	seen[entry] = 1;
+	stack.push_back({ entry, succStart[entry] });
+	while (!stack.empty()) {
+		int seg = stack.back().first;
+		int e = stack.back().second;
+		if (e < succStart[seg + 1]) {
+			stack.back().second++;
+			if (!seen[succs[e]]) {
+				seen[succs[e]] = 1;
+				stack.push_back({ succs[e], succStart[succs[e]] });
 			}
+		} else {
+			order.push_back(seg);
+			stack.pop_back();
 		}
-
 	}
-}
-
-bool SSA::checkInterferesWith(IGraphNode* node, SSAValue* instr) {
-	for (IGraphNode* iNode : node->connectedTo) {
-		for (SSAValue* val : iNode->values) {
-			if (val == instr) {
-				return true;
-			}
+	for (int seg = 0; seg < numSegments; seg++) {
+		if (!seen[seg]) {
+			order.push_back(seg);
 		}
 	}
-	return false;
-}
 
-int SSA::findIndexOfIGraphNode(IGraphNode* toFindNode) {
+	BitSet out(globals.size());
+	std::vector<char> pending(numSegments, 1);
+	bool anyPending = true;
+	while (anyPending) {
+		anyPending = false;
+		for (int seg : order) {
+			if (!pending[seg]) {
+				continue;
+			}
+			pending[seg] = 0;
 
-	for (int i = 0; i < iGraphNodes.size(); i++) {
-		if (iGraphNodes.at(i) == toFindNode) {
-			return i;
+			// live in gets what is live out and not defined here, the uses
+			// are already in it
+			std::pair<size_t, size_t> outWords = gatherLiveOut(seg, out.data());
+			if (outWords.first >= outWords.second) {
+				continue;
+			}
+			size_t defFirst = segmentGlobals[seg];
+			size_t defEnd = segmentGlobals[seg + 1];
+			for (size_t w = std::max(outWords.first, defFirst / BITSET_WORD_BITS); w < outWords.second && w * BITSET_WORD_BITS < defEnd; w++) {
+				size_t wordFirst = w * BITSET_WORD_BITS;
+				size_t low = std::max(defFirst, wordFirst) - wordFirst;
+				size_t high = std::min(defEnd, wordFirst + BITSET_WORD_BITS) - wordFirst;
+				uint64_t below = high == BITSET_WORD_BITS ? ~(uint64_t)0 : ((uint64_t)1 << high) - 1;
+				out.data()[w] &= ~(below & ~(((uint64_t)1 << low) - 1));
+			}
+			uint64_t* in = liveIn.data() + seg * words;
+			bool changed = bits->unionWith(in + outWords.first, out.data() + outWords.first, outWords.second - outWords.first);
+			std::fill(out.data() + outWords.first, out.data() + outWords.second, 0);
+			if (changed) {
+				widen(inWords[seg], outWords.first, outWords.second);
+				for (int p = predStart[seg]; p < predStart[seg + 1]; p++) {
+					if (!pending[preds[p]]) {
+						pending[preds[p]] = 1;
+						anyPending = true;
+					}
+				}
+			}
 		}
 	}
-	return -1;
-}
-
-void SSA::addNewEdges(IGraphNode* newConnection, IGraphNode* oldConnection) {
-	std::vector<IGraphNode*> toEraseFrom;
-	for (IGraphNode* node : iGraphNodes) {
-		for (IGraphNode* connection : node->connectedTo) {
 
-			if (connection == oldConnection) {
-				node->connectedTo.insert(newConnection);
-				toEraseFrom.push_back(node);
+	// what is live across each definition. globals are tracked in their
+	// own bits, locals in bits over every value of which only the
+	// segment's own range is ever set
+	BitSet liveGlobals(globals.size());
+	BitSet liveLocals(values.size());
+	std::vector<std::pair<int, int>> interferes;
+	std::vector<char> inGraph(values.size(), 0);
+	for (int seg = 0; seg < numSegments; seg++) {
+		std::pair<size_t, size_t> globalWords = gatherLiveOut(seg, liveGlobals.data());
+		size_t localFirst = segmentValues[seg] / BITSET_WORD_BITS;
+		size_t localEnd = bitsetWords(segmentValues[seg + 1]);
+		for (SSAValue* iter = segments[seg].last; iter != nullptr; iter = iter->prev) {
+			int index = iter->info->liveIndex;
+			int global = globalIndex[index];
+			bool used;
+			if (global >= 0) {
+				used = liveGlobals.test(global);
+				liveGlobals.reset(global);
+			} else {
+				used = liveLocals.test(index);
+				liveLocals.reset(index);
+			}
+			if ((iter->op < BRA || iter->op > NOP) && !iter->isVoidCall) {
+				iter->deadCode = !used && iter->op != write && iter->op != writeNL && iter->op != ret;
+				if (!iter->deadCode) {
+					inGraph[index] = 1;
+					forEachBit(liveGlobals.data(), globalWords.first, globalWords.second, [&](size_t global) {
+						interferes.push_back({ index, globals[global] });
+					});
+					forEachBit(liveLocals.data(), localFirst, localEnd, [&](size_t local) {
+						interferes.push_back({ index, (int)local });
+					});
+				}
 			}
+			forEachUse(values, iter, [&](int use) {
+				if (globalIndex[use] >= 0) {
+					liveGlobals.set(globalIndex[use]);
+					widen(globalWords, globalIndex[use] / BITSET_WORD_BITS, globalIndex[use] / BITSET_WORD_BITS + 1);
+				} else {
+					liveLocals.set(use);
+				}
+			});
+			if (iter == segments[seg].first) {
+				break;
+			}
+		}
+		// locals are all cleared at their definitions
+		if (globalWords.first < globalWords.second) {
+			std::fill(liveGlobals.data() + globalWords.first, liveGlobals.data() + globalWords.second, 0);
+		}
+	}
+
+	// every value defined and not dead gets a node, in value order
+	for (auto& edge : interferes) {
+		inGraph[edge.second] = 1;
+	}
+	int numNodes = 0;
+	for (int index = 0; index < (int)values.size(); index++) {
+		values[index]->info->nodeIndex = inGraph[index] ? numNodes++ : -1;
+	}
+	interference.reset(numNodes);
+	for (SSAValue* value : values) {
+		if (value->info->nodeIndex >= 0) {
+			interference.values[value->info->nodeIndex] = value;
 		}
 	}
-	for (IGraphNode* node : toEraseFrom) {
-		node->connectedTo.erase(oldConnection);
+	for (auto& edge : interferes) {
+		interference.addEdge(values[edge.first]->info->nodeIndex, values[edge.second]->info->nodeIndex);
 	}
 }
-void SSA::coalescePhi(IGraphNode* node, std::vector<IGraphNode*>& toDelete) {
-	node->visited = true;
-	SSAValue* val = node->initValue;
-	SSAValue* phiOperand1 = val->operand1;
-	SSAValue* phiOperand2 = val->operand2;
 
+IGraphNode* SSA::findInIGraphNodes(SSAValue* toFind) {
+	if (toFind == nullptr || toFind->info == nullptr) {
+		return nullptr;
+	}
+	int id = toFind->info->nodeIndex;
+	if (id < 0 || id >= (int)nodesById.size()) {
+		return nullptr;
+	}
+	IGraphNode* node = nodesById[id];
+	if (node->initValue != toFind || node->index < 0) {
+		return nullptr;
+	}
+	return node;
+}
 
-	if (phiOperand1 != nullptr && phiOperand1->op != CONST) {
+IGraphNode::IGraphNode(SSAValue* val, int nodeID) {
+	initValue = val;
+	values.insert(val);
+	id = nodeID;
+	index = -1;
+	moveTarget = nullptr;
+	color = -1;
+}
 
-		if (!checkInterferesWith(node, phiOperand1)) {
-			IGraphNode* phiNode = nullptr;
-			if (phiOperand1->op == PHI) {
-				phiNode = findInIGraphNodes(phiOperand1);
-				if (phiNode == nullptr) {
-				} else {
-					coalescePhi(phiNode, toDelete);
-					for (SSAValue* nodeVal : phiNode->values) {
-						node->values.insert(nodeVal);
-					}
+// a node for every node of the interference graph, the edges stay there
+void SSA::generateIGraphNodes() {
+	nodesById.clear();
+	iGraphNodes.clear();
+	for (int id = 0; id < interference.size(); id++) {
+		IGraphNode* node = arena.nodes.create(interference.values[id], id);
+		node->index = id;
+		nodesById.push_back(node);
+		iGraphNodes.push_back(node);
+	}
+}
 
-				}
-			} else {
-				// operand1 is not a phi instr
-				phiNode = findInIGraphNodes(phiOperand1);
-				for (SSAValue* nodeVal : phiNode->values) {
-					node->values.insert(nodeVal);
-				}
-			}
-			node->values.insert(phiOperand1);
+int SSA::findIndexOfIGraphNode(IGraphNode* toFindNode) {
+	return toFindNode->index;
+}
 
-			if (phiNode != nullptr) {
-				for (IGraphNode* newInter : phiNode->connectedTo) {
-					node->connectedTo.insert(newInter);
-				}
-				toDelete.push_back(phiNode);
-				addNewEdges(node, phiNode);
-				node->values.erase(val);
-			}
-		} else {
-			IGraphNode* phiOp1Node = findInIGraphNodes(phiOperand1);
-			phiOp1Node->moveTarget = node;
-		}
+// the last node takes the removed one's place
+void SSA::removeIGraphNode(IGraphNode* node) {
+	if (node->index < 0) {
+		return;
 	}
-	if (phiOperand2 != nullptr && phiOperand2->op != CONST) {
-
-		if (!checkInterferesWith(node, phiOperand2)) {
-			IGraphNode* phiNode = nullptr;
-			if (phiOperand2->op == PHI) {
-				phiNode = findInIGraphNodes(phiOperand2);
-				coalescePhi(phiNode, toDelete);
-				if (phiNode == nullptr) {
-				}
-				for (SSAValue* nodeVal : phiNode->values) {
-					node->values.insert(nodeVal);
-				}
-			} else {
-				// operand2 of phi is not a phi
-				phiNode = findInIGraphNodes(phiOperand2);
-				for (SSAValue* nodeVal : phiNode->values) {
-					node->values.insert(nodeVal);
-				}
-			}
-			node->values.insert(phiOperand2);
-			if (phiNode != nullptr) {
-				for (IGraphNode* newInter : phiNode->connectedTo) {
-					node->connectedTo.insert(newInter);
-				}
-				toDelete.push_back(phiNode);
-				addNewEdges(node, phiNode);
-				node->values.erase(val);
+	IGraphNode* last = iGraphNodes.back();
+	iGraphNodes[node->index] = last;
+	last->index = node->index;
+	iGraphNodes.pop_back();
+	node->index = -1;
+}
+
+// whether a node in a's set interferes with one in b's, walks the edges of
+// the smaller set
+bool SSA::setsInterfere(int a, int b) {
+	if (coalesced.size(a) > coalesced.size(b)) {
+		std::swap(a, b);
+	}
+	int other = coalesced.find(b);
+	bool found = false;
+	coalesced.forEachMember(a, [&](int member) {
+		for (int neighbor : interference.neighbors(member)) {
+			if (coalesced.find(neighbor) == other) {
+				found = true;
+				return false;
 			}
+		}
+		return true;
+	});
+	return found;
+}
+
+// each operand joins the phi's set unless the sets interfere, then it gets
+// moved into the phi's register instead
+void SSA::coalescePhi(IGraphNode* node, std::vector<std::pair<int, int>>& moves) {
+	SSAValue* operands[2] = { node->initValue->operand1, node->initValue->operand2 };
+	for (SSAValue* operand : operands) {
+		if (operand == nullptr || operand->op == CONST) {
+			continue;
+		}
+		IGraphNode* operandNode = findInIGraphNodes(operand);
+		if (operandNode == nullptr) {
+			// not in the graph, it interferes with nothing
+			node->values.insert(operand);
+		} else if (!setsInterfere(node->id, operandNode->id)) {
+			coalesced.unite(node->id, operandNode->id);
 		} else {
-			IGraphNode* phiOp2Node = findInIGraphNodes(phiOperand2);
-			phiOp2Node->moveTarget = node;
+			moves.push_back({ operandNode->id, node->id });
 		}
 	}
 }
 
+// union find over the nodes, edges and values only move to the leaders
+// once every set is final
 void SSA::clusterIGraphNodes() {
-
-	std::vector<IGraphNode*> toDelete;
+	coalesced.reset(interference.size());
+	std::vector<std::pair<int, int>> moves;
 	for (IGraphNode* node : iGraphNodes) {
-		SSAValue* val = node->initValue;
-		if (val->op == PHI && !node->visited) {
-			coalescePhi(node, toDelete);
+		if (node->initValue->op == PHI) {
+			coalescePhi(node, moves);
 		}
 	}
-	for (auto node : toDelete) {
-		int index = findIndexOfIGraphNode(node);
-		if (index >= 0) {
-			iGraphNodes.erase(iGraphNodes.begin() + index);
+
+	std::vector<int> into(interference.size());
+	for (int id = 0; id < interference.size(); id++) {
+		into[id] = coalesced.leader(id);
+	}
+	interference.mergeNodes(into);
+	for (int id = 0; id < interference.size(); id++) {
+		if (into[id] != id) {
+			IGraphNode* node = nodesById[id];
+			nodesById[into[id]]->values.insert(node->values.begin(), node->values.end());
+			removeIGraphNode(node);
 		}
 	}
-
+	for (auto& move : moves) {
+		nodesById[into[move.first]]->moveTarget = nodesById[into[move.second]];
+	}
 }
 
-std::string IGraphNode::iGraphNodeRepr() {
-	std::string output = std::to_string(id) + "[shape=record, style=filled,colorscheme=pastel19,fillcolor=" + std::to_string(color) + ",label=\"< b > " + std::to_string(id) + "| {Init Value : " + initValue->instCFGRepr() + " | ";
+std::string IGraphNode::iGraphNodeRepr(const InterferenceGraph& graph) {
+	std::string valueID = std::to_string(initValue->id);
+	std::string output = valueID + "[shape=record, style=filled,colorscheme=pastel19,fillcolor=" + std::to_string(color) + ",label=\"< b > " + valueID + "| {Init Value : " + initValue->instCFGRepr() + " | ";
 	output += "Values |";
 	for (SSAValue* val : values) {
 		output += val->instCFGRepr() + "|";
 	}
 	output += "Connected to |";
-	for (IGraphNode* node : connectedTo) {
-		output += " " + std::to_string(node->id) + ",";
+	for (int node : graph.neighbors(id)) {
+		output += " " + std::to_string(graph.values[node]->id) + ",";
 	}
 	output.pop_back();
 	if (moveTarget != nullptr) {
-		output += "| Move Target |" + std::to_string(moveTarget->id);
+		output += "| Move Target |" + std::to_string(moveTarget->initValue->id);
 	}
 	output += "| Color | " + std::to_string(color);
 	output += "}\"]\n";
-	for (IGraphNode* node : connectedTo) {
-		output += std::to_string(id) + "--" + std::to_string(node->id) + "[arrowhead=none]\n";
+	for (int node : graph.neighbors(id)) {
+		output += valueID + "--" + std::to_string(graph.values[node]->id) + "[arrowhead=none]\n";
 	}
 	return output;
 }
@@ -1330,126 +1687,88 @@ void SSA::printClusteredIGraph() {
 	std::cout << "strict graph clusteredIGraph {" << std::endl;
 	for (IGraphNode* node : iGraphNodes) {
 		if (node != nullptr) {
-			std::cout << node->iGraphNodeRepr() << std::endl;
+			std::cout << node->iGraphNodeRepr(interference) << std::endl;
 
 		}
 	}
 	std::cout << "}" << std::endl;
 }
 
-IGraphNode* SSA::pickNode(std::vector<IGraphNode*> nodes) {
-	int numRegisters = 5;
-	IGraphNode* minNode = nullptr;
-	int minNeighbors = 100;
-	for (auto node : nodes) {
-		int numNeighbors = node->connectedTo.size();
-		if (numNeighbors < minNeighbors) {
-			minNode = node;
-			minNeighbors = numNeighbors;
-		}
-		if (numNeighbors < numRegisters) {
-			return node;
-		}
-	}
-	return minNode;
-}
+// colors 1 to NUM_REGISTERS are real registers, the ones after are virtual
+static const int NUM_REGISTERS = 5;
 
+// the lowest real register no colored neighbor has, else the lowest virtual
+// one, a new one if those are all taken too
 int SSA::pickColor(IGraphNode* node) {
-	int possibleColors[5] = { 1, 2, 3, 4, 5 };
 	std::vector<int> neighborColors;
-	for (IGraphNode* connection : node->connectedTo) {
-		if (connection != nullptr && connection->color != -1) {
-			for (int i = 0; i < 5; i++) {
-				neighborColors.push_back(connection->color);
-				if (possibleColors[i] == connection->color) {
-					possibleColors[i] = 0;
-				}
-			}
-		}
-	}
-	bool colorExists = false;
-	for (int color : possibleColors) {
-		if (color != 0) {
-			colorExists = true;
-			return color;
+	for (int neighbor : interference.neighbors(node->id)) {
+		int color = nodesById[neighbor]->color;
+		if (color != -1) {
+			neighborColors.push_back(color);
 		}
 	}
-	if (!colorExists) {
-		if (virtualRegColors.size() == 0) {
-			virtualRegColors.push_back(6);
-		}
-		bool foundSuitableVRegColor = false;
-		for (int vRegColor : virtualRegColors) {
-			bool noNeighborSharesColor = true;
-			for (int neighborColor : neighborColors) {
-				if (vRegColor == neighborColor) {
-					noNeighborSharesColor = false;
-				}
-			}
-			if (noNeighborSharesColor) {
-				foundSuitableVRegColor = true;
-				return vRegColor;
-				break;
-			}
+	std::sort(neighborColors.begin(), neighborColors.end());
+	int color = 1;
+	for (int taken : neighborColors) {
+		if (taken > color) {
+			break;
 		}
-		if (!foundSuitableVRegColor) {
-			int newRegColor = virtualRegColors.back() + 1;
-			virtualRegColors.push_back(newRegColor);
-			return newRegColor;
+		if (taken == color) {
+			color++;
 		}
 	}
+	if (color > NUM_REGISTERS && (virtualRegColors.empty() || virtualRegColors.back() < color)) {
+		virtualRegColors.push_back(color);
+	}
+	return color;
 }
 
+// Chaitin's simplify and select without the recursion. simplify takes out
+// the node of lowest degree until none are left, nodes with NUM_REGISTERS
+// or more neighbors go too and may still find a register in select
+// (Briggs' optimistic coloring). select colors them in reverse order, each
+// node against the neighbors colored before it
 void SSA::colorGraph() {
-
-	int numRegisters = 5;
-	IGraphNode* node = pickNode(iGraphNodes);
-	if (node == nullptr) {
-		return;
-	}
-	int index = findIndexOfIGraphNode(node);
-	if (iGraphNodes.size() != 0 && index >= 0) {
-		iGraphNodes.erase(iGraphNodes.begin() + index);
-	}
-	std::vector<IGraphNode*> addBackTo;
-	for (auto editNode : node->connectedTo) {
-		if (editNode != nullptr) {
-			addBackTo.push_back(editNode);
-			editNode->connectedTo.erase(node);
+	DegreeBuckets buckets;
+	buckets.reset(interference.size());
+	for (IGraphNode* node : iGraphNodes) {
+		buckets.insert(node->id, interference.degree(node->id));
+	}
+	std::vector<IGraphNode*> stack;
+	stack.reserve(iGraphNodes.size());
+	while (!buckets.empty()) {
+		int id = buckets.popMin();
+		for (int neighbor : interference.neighbors(id)) {
+			if (buckets.contains(neighbor)) {
+				buckets.decrement(neighbor);
+			}
 		}
+		stack.push_back(nodesById[id]);
 	}
-	if (iGraphNodes.size() != 0) {
 
-		colorGraph();
-	}
-	iGraphNodes.push_back(node);
-
-	for (auto editNode : addBackTo) {
-		if (editNode != nullptr) {
-			editNode->connectedTo.insert(node);
-		}
+	iGraphNodes.clear();
+	for (auto iter = stack.rbegin(); iter != stack.rend(); iter++) {
+		IGraphNode* node = *iter;
+		node->color = pickColor(node);
+		node->index = (int)iGraphNodes.size();
+		iGraphNodes.push_back(node);
 	}
-	node->color = pickColor(node);
-
-	return;
-
-
 }
 
 void SSA::generateRegisters() {
 	for (auto node : iGraphNodes) {
-		try {
-			Register* reg = registers.at(node->color);
+		auto found = registers.find(node->color);
+		if (found != registers.end()) {
+			Register* reg = found->second;
 			for (auto val : node->values) {
 				reg->values.insert(val);
 			}
 			reg->values.insert(node->initValue);
 
-		}
-		catch (std::out_of_range& oor) {
-			Register* newReg = new Register();
+		} else {
+			Register* newReg = arena.registers.create();
 			newReg->id = node->color;
-			if (node->color > 5) {
+			if (node->color > NUM_REGISTERS) {
 				newReg->isVirtual = true;
 			}
 			for (auto val : node->values) {
@@ -1480,14 +1799,14 @@ void SSA::printRegisters() {
 void SSA::setRegisters() {
 	for (auto kv : registers) {
 		for (SSAValue* val : kv.second->values) {
-			val->regNum = kv.first;
+			val->info->regNum = kv.first;
 		}
 	}
 	for (auto node : iGraphNodes) {
 		IGraphNode* moveTarget = node->moveTarget;
 		if (moveTarget != nullptr) {
 			for (SSAValue* val : node->values) {
-				val->regToMoveTo = moveTarget->initValue->regNum;
+				val->info->regToMoveTo = moveTarget->initValue->info->regNum;
 			}
 		}
 	}
@@ -1502,10 +1821,10 @@ void SSA::cleanInstList() {
 		if (iter->deadCode) {
 			SSAValue* iterPrev = iter->prev;
 			SSAValue* iterNext = iter->next;
-			BasicBlock* containingBB = iter->containingBB;
+			BasicBlock* containingBB = iter->info->containingBB;
 			if (iter == containingBB->head) {
 				if (iterNext != nullptr) {
-					if (iterNext->containingBB == containingBB) {
+					if (iterNext->info->containingBB == containingBB) {
 						containingBB->head = iterNext;
 					} else {
 						containingBB->head = nullptr;
@@ -1517,10 +1836,10 @@ void SSA::cleanInstList() {
 			}
 			if (iter == containingBB->tail) {
 				if (iterNext != nullptr) {
-					if (iterNext->containingBB == containingBB) {
+					if (iterNext->info->containingBB == containingBB) {
 						containingBB->tail = iterNext;
 					} else {
-						if (iterPrev->containingBB == containingBB) {
+						if (iterPrev->info->containingBB == containingBB) {
 							containingBB->tail = iterPrev;
 						} else {
 							containingBB->tail = nullptr;
@@ -1528,7 +1847,7 @@ void SSA::cleanInstList() {
 						}
 					}
 				} else {
-					if (iterPrev->containingBB == containingBB) {
+					if (iterPrev->info->containingBB == containingBB) {
 						containingBB->tail = iterPrev;
 					} else {
 						containingBB->tail = nullptr;
@@ -1549,24 +1868,24 @@ void SSA::cleanInstList() {
 		else if (iter->op == PHI) {
 			SSAValue* phiOperand1 = iter->operand1;
 			SSAValue* phiOperand2 = iter->operand2;
-			if (phiOperand1->regToMoveTo != 0 || phiOperand1->op == CONST) {
+			if (phiOperand1->info->regToMoveTo != 0 || phiOperand1->op == CONST) {
 				SSAValue* moveInstr;
 				BasicBlock* bbToAddMoveIn;
 				if (phiOperand1->op == CONST) {
-					if (iter->containingBB->branchFrom != nullptr && iter->containingBB->branchFrom->conditionalBlockType == "ifThenElse-Then") {
-						bbToAddMoveIn = iter->containingBB->branchFrom;
-					} else if (iter->containingBB->fallThroughFrom != nullptr && iter->containingBB->fallThroughFrom->conditionalBlockType == "ifThen-Then") {
-						bbToAddMoveIn = iter->containingBB->fallThroughFrom;
+					if (iter->info->containingBB->pred[EDGE_BR] != nullptr && iter->info->containingBB->pred[EDGE_BR]->conditionalBlockType == IF_THEN_ELSE_THEN) {
+						bbToAddMoveIn = iter->info->containingBB->pred[EDGE_BR];
+					} else if (iter->info->containingBB->pred[EDGE_FT] != nullptr && iter->info->containingBB->pred[EDGE_FT]->conditionalBlockType == IF_THEN_THEN) {
+						bbToAddMoveIn = iter->info->containingBB->pred[EDGE_FT];
 					} else {
-						bbToAddMoveIn = iter->containingBB;
+						bbToAddMoveIn = iter->info->containingBB;
 					}
-					moveInstr = SSACreateConstMove(phiOperand1, iter->regNum);
+					moveInstr = SSACreateConstMove(phiOperand1, iter->info->regNum);
 				} else {
-					bbToAddMoveIn = phiOperand1->containingBB;
-					moveInstr = SSACreateMove(phiOperand1->regNum, phiOperand1->regToMoveTo);
+					bbToAddMoveIn = phiOperand1->info->containingBB;
+					moveInstr = SSACreateMove(phiOperand1->info->regNum, phiOperand1->info->regToMoveTo);
 
 				}
-				if (bbToAddMoveIn != iter->containingBB) {
+				if (bbToAddMoveIn != iter->info->containingBB) {
 					if (bbToAddMoveIn->tail != nullptr) {
 						SSAValue* currentTail = bbToAddMoveIn->tail;
 						SSAValue* currentTailNext = currentTail->next;
@@ -1594,10 +1913,10 @@ void SSA::cleanInstList() {
 						
 						bbToAddMoveIn->head = moveInstr;
 						bbToAddMoveIn->tail = moveInstr;
-						moveInstr->prev = bbToAddMoveIn->fallThroughFrom->tail;
-						bbToAddMoveIn->fallThroughFrom->tail->next = moveInstr;
-						moveInstr->next = bbToAddMoveIn->fallThrough->head;
-						bbToAddMoveIn->fallThrough->head->prev = moveInstr;
+						moveInstr->prev = bbToAddMoveIn->pred[EDGE_FT]->tail;
+						bbToAddMoveIn->pred[EDGE_FT]->tail->next = moveInstr;
+						moveInstr->next = bbToAddMoveIn->succ[EDGE_FT]->head;
+						bbToAddMoveIn->succ[EDGE_FT]->head->prev = moveInstr;
 					}
 
 				} else {
@@ -1622,22 +1941,22 @@ void SSA::cleanInstList() {
 				}
 
 			}
-			if (phiOperand2->regToMoveTo != 0 || phiOperand2->op == CONST) {
+			if (phiOperand2->info->regToMoveTo != 0 || phiOperand2->op == CONST) {
 
 				SSAValue* moveInstr;
 				BasicBlock* bbToAddMoveIn;
 				if (phiOperand2->op == CONST) {
-					if (iter->containingBB->fallThroughFrom != nullptr && iter->containingBB->fallThroughFrom->conditionalBlockType == "ifThenElse-Else") {
-						bbToAddMoveIn = iter->containingBB->fallThroughFrom;
-					} else if (iter->containingBB->branchFrom != nullptr && iter->containingBB->branchFrom->splitType == "if") {
-						bbToAddMoveIn = iter->containingBB->branchFrom;
+					if (iter->info->containingBB->pred[EDGE_FT] != nullptr && iter->info->containingBB->pred[EDGE_FT]->conditionalBlockType == IF_THEN_ELSE_ELSE) {
+						bbToAddMoveIn = iter->info->containingBB->pred[EDGE_FT];
+					} else if (iter->info->containingBB->pred[EDGE_BR] != nullptr && iter->info->containingBB->pred[EDGE_BR]->splitType == SPLIT_IF) {
+						bbToAddMoveIn = iter->info->containingBB->pred[EDGE_BR];
 					} else {
-						bbToAddMoveIn = iter->containingBB;
+						bbToAddMoveIn = iter->info->containingBB;
 					}
-					moveInstr = SSACreateConstMove(phiOperand2, iter->regNum);
+					moveInstr = SSACreateConstMove(phiOperand2, iter->info->regNum);
 				} else {
-					bbToAddMoveIn = phiOperand2->containingBB;
-					moveInstr = SSACreateMove(phiOperand2->regNum, phiOperand2->regToMoveTo);
+					bbToAddMoveIn = phiOperand2->info->containingBB;
+					moveInstr = SSACreateMove(phiOperand2->info->regNum, phiOperand2->info->regToMoveTo);
 
 				}
 				SSAValue* currentTail = bbToAddMoveIn->tail;
@@ -1656,22 +1975,21 @@ void SSA::cleanInstList() {
 					currentTailNext->prev = moveInstr;
 
 				}
-				if (bbToAddMoveIn->splitType == "if") {
-					BasicBlock* moveBB = new BasicBlock();
-					moveBB->id = maxBlockID++;
+				if (bbToAddMoveIn->splitType == SPLIT_IF) {
+					BasicBlock* moveBB = arena.blocks.create();
+					addBlock(moveBB);
 					moveBB->funcName = funcName;
-					basicBlocks.push_back(moveBB);
 
-					BasicBlock* joinBlock = bbToAddMoveIn->branch;
+					BasicBlock* joinBlock = bbToAddMoveIn->succ[EDGE_BR];
 					if (moveInstr->prev->op >= BNE && moveInstr->prev->op <= BGT) {
 						SSAValue* finalTarget = moveInstr->prev->operand2;
 						SSAValue* newNop = SSACreateNop();
 						newNop->id = maxID++;
 						moveInstr->prev->operand2 = newNop;
-						newNop->label = funcName + std::to_string(labelCount);
+						newNop->info->label = funcName + std::to_string(labelCount);
 
 						moveBB->head = newNop;
-						SSAValue* braInstr = new SSAValue();
+						SSAValue* braInstr = newValue();
 						braInstr->op = BRA;
 						braInstr->id = maxID++;
 						braInstr->operand1 = finalTarget;
@@ -1693,10 +2011,10 @@ void SSA::cleanInstList() {
 						moveInstrNext->prev = braInstr;
 						
 
-						bbToAddMoveIn->branch = moveBB;
-						moveBB->branchFrom = bbToAddMoveIn;
-						moveBB->branch = joinBlock;
-						joinBlock->branchFrom = moveBB;
+						bbToAddMoveIn->succ[EDGE_BR] = moveBB;
+						moveBB->pred[EDGE_BR] = bbToAddMoveIn;
+						moveBB->succ[EDGE_BR] = joinBlock;
+						joinBlock->pred[EDGE_BR] = moveBB;
 						
 
 					} else {
@@ -1710,10 +2028,10 @@ void SSA::cleanInstList() {
 
 			SSAValue* iterPrev = iter->prev;
 			SSAValue* iterNext = iter->next;
-			BasicBlock* containingBB = iter->containingBB;
+			BasicBlock* containingBB = iter->info->containingBB;
 			if (iter == containingBB->head) {
 				if (iterNext != nullptr) {
-					if (iterNext->containingBB == containingBB) {
+					if (iterNext->info->containingBB == containingBB) {
 						containingBB->head = iterNext;
 					} else {
 						containingBB->head = nullptr;
@@ -1727,10 +2045,10 @@ void SSA::cleanInstList() {
 
 			if (iter == containingBB->tail) {
 				if (iterNext != nullptr) {
-					if (iterNext->containingBB == containingBB) {
+					if (iterNext->info->containingBB == containingBB) {
 						containingBB->tail = iterNext;
 					} else {
-						if (iterPrev->containingBB == containingBB) {
+						if (iterPrev->info->containingBB == containingBB) {
 							containingBB->tail = iterPrev;
 						} else {
 							containingBB->tail = nullptr;
@@ -1738,7 +2056,7 @@ void SSA::cleanInstList() {
 						}
 					}
 				} else {
-					if (iterPrev->containingBB == containingBB) {
+					if (iterPrev->info->containingBB == containingBB) {
 						containingBB->tail = iterPrev;
 					} else {
 						containingBB->tail = nullptr;
@@ -1757,26 +2075,26 @@ void SSA::cleanInstList() {
 		}
 
 		if (iter != nullptr && iter->op == BRA) {
-			iter->operand1->label = funcName + std::to_string(labelCount);
+			iter->operand1->info->label = funcName + std::to_string(labelCount);
 			labelCount++;
 		}
 		if (iter != nullptr && iter->op >= BNE && iter->op <= BGT) {
-			iter->operand2->label = funcName + std::to_string(labelCount);
+			iter->operand2->info->label = funcName + std::to_string(labelCount);
 			labelCount++;
 		}
 		if (iter->op == NOP) {
-			if (iter->containingBB->loop != nullptr) {
+			if (iter->info->containingBB->succ[EDGE_LOOP] != nullptr) {
 				// nop at top of while body
 				
 				SSAValue* nopPrevInst = iter->prev;
 				SSAValue* nopNextInst = iter->next;
 				nopPrevInst->next = nopNextInst;
 				nopNextInst->prev = nopPrevInst;
-				if (iter->containingBB == nopNextInst->containingBB) {
-					iter->containingBB->head = nopNextInst;
+				if (iter->info->containingBB == nopNextInst->info->containingBB) {
+					iter->info->containingBB->head = nopNextInst;
 				} else {
-					iter->containingBB->head = nullptr;
-					iter->containingBB->tail = nullptr;
+					iter->info->containingBB->head = nullptr;
+					iter->info->containingBB->tail = nullptr;
 				}
 			}
 			
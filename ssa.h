@@ -2,6 +2,10 @@
 #define __SSA_H__
 
 #include "token.h"
+#include "arena.h"
+#include "dominators.h"
+#include "bitset.h"
+#include "interference.h"
 #include <unordered_map>
 #include <set>
 #include <tuple>
@@ -42,39 +46,21 @@ enum opcode {
 
 class BasicBlock;
 
+class SSAValueInfo;
+
+// one instruction. only what the passes walk over on every value is kept
+// here, the rest lives in its SSAValueInfo
 class SSAValue {
     public:
-        opcode op;
-        int constValue;
-        int id;
         SSAValue *operand1, *operand2;
-		std::string op1Name, op2Name;
         SSAValue *prev, *next;
-        SSAValue *inCreationOrder; 
-        SSAValue *prevDomWithOpcode; // wtf is this
-		bool eliminated;
-		SSAValue* eliminatedBy;
-		std::string argName;
-		std::vector<SSAValue*> callArgs;
-		std::vector<std::string> formalParams;
-
-		bool isVoidCall;
-
-
-		int bbID;
-		bool firstInstOfBB;
-
-		bool deadCode;
-
-		int regNum;
-
-		int regToMoveFrom;
-		int regToMoveTo;
-
-		
-
-		std::string label;
-		BasicBlock* containingBB;
+		SSAValueInfo* info;
+        int id;
+        opcode op : 8;
+		bool eliminated : 1;
+		bool isVoidCall : 1;
+		bool deadCode : 1;
+		bool pending : 1;	// can still be replaced, see SSA::exitLoop
 
 		void setOpNames(std::string operand1Name, std::string operand2Name);
 
@@ -94,47 +80,62 @@ class SSAValue {
 		std::string elimRepr();
 		std::string moveRepr();
 		std::string moveConstRepr();
+};
 
+// fields of an SSAValue only some opcodes or some passes need, allocated
+// next to it by the SSA that owns it
+class SSAValueInfo {
+	public:
+		int constValue;
+		std::string op1Name, op2Name;
+		SSAValue *prevDomWithOpcode; // wtf is this
+		SSAValue* eliminatedBy;
+
+		// calls and args
+		std::string argName;
+		std::vector<SSAValue*> callArgs;
+		std::vector<std::string> formalParams;
 
+		// register allocation
+		int regNum;
+		int regToMoveFrom;
+		int regToMoveTo;
 
+		std::string label;
+		BasicBlock* containingBB;
 
-    private:
-        //hash_map will be implemented, details still needed
-        //std::unordered_map<>
-		std::string opcodeEnumStrings[28] = {
-			"NEG",        
-			"ADDOP",        
-			"SUBOP",        
-			"MULOP",        
-			"DIVOP",        
-			"CMP",        
-			"ADDA",       
-			"LOAD",       
-			"STORE",      
-			"PHI",        
-			"END",       
-			"BRA",       
-			"BNE",       
-			"BEQ",       
-			"BLE",       
-			"BLT",       
-			"BGE",       
-			"BGT",       
-			"CONST",
-			"NOP",
-			"read",      
-			"write",     
-			"writeNL",
-			"argAssign",
-			"call",
-			"return",
-			"move",
-			"moveConst"
-		};
+		int liveIndex;	// bit in the liveness sets, see SSA::computeLiveness
+		int nodeIndex;	// node in SSA::interference, -1 if it has none
+};
 
+// what the parser built a block for. the traversal and liveness passes
+// switch on these instead of comparing strings
+enum blockJoin : unsigned char {
+	JOIN_NONE = 0,
+	JOIN_IF = 1,		// where the two sides of an if meet
+	JOIN_WHILE = 2		// while header, the loop edge comes back to it
+};
 
+enum blockSplit : unsigned char {
+	SPLIT_NONE = 0,
+	SPLIT_IF = 1		// ends in the branch of an if
+};
 
+// which side of an if a block sits on
+enum blockSide : unsigned char {
+	SIDE_NONE = 0,
+	IF_THEN_ELSE_THEN = 1,
+	IF_THEN_ELSE_ELSE = 2,
+	IF_THEN_THEN = 3
+};
 
+// index into BasicBlock::succ and BasicBlock::pred. pred[EDGE_FT] is the
+// block whose succ[EDGE_FT] leads here, and so on
+enum edgeKind {
+	EDGE_FT = 0,	// fall through
+	EDGE_BR = 1,	// branch
+	EDGE_LOOP = 2,	// back to a while header
+	NUM_EDGE_KINDS = 3
 };
 
 class BasicBlock {
@@ -148,34 +149,21 @@ class BasicBlock {
 		SSAValue* head;
 		SSAValue* tail;
 
-		BasicBlock* loopBackFrom;
-		BasicBlock* fallThroughFrom;
-		BasicBlock* branchFrom;
-
-		BasicBlock* loop;
+		BasicBlock* succ[NUM_EDGE_KINDS];
+		BasicBlock* pred[NUM_EDGE_KINDS];
 
-		BasicBlock* fallThrough;
-		BasicBlock* branch;
-		bool addToHead;
-		bool headAdded;
-		std::string joinType;
-		std::string splitType;
 		std::string funcName;
 		BasicBlock* dom;
-		bool visited;
-		bool ifThenJoinBlock; // technically if then else join block
-		bool alreadyConnectedBranch;
-		bool alreadyConnectedFT;
-		bool alreadyConnected;
-		int numVisits;
-
-		void unionLiveRanges(BasicBlock* toUnionFrom, std::string edgeType);
-
-		std::set<SSAValue*> liveRanges;
-		std::vector<SSAValue*> phis;
-
-		std::string conditionalBlockType;
 
+		blockJoin joinType : 2;
+		blockSplit splitType : 1;
+		blockSide conditionalBlockType : 2;
+		bool addToHead : 1;
+		bool headAdded : 1;
+		bool ifThenJoinBlock : 1; // technically if then else join block
+		bool alreadyConnectedBranch : 1;
+		bool alreadyConnectedFT : 1;
+		bool alreadyConnected : 1;
 };
 
 class IGraphNode {
@@ -183,11 +171,10 @@ class IGraphNode {
 		IGraphNode(SSAValue* val, int nodeID);
 		SSAValue* initValue;
 		std::set<SSAValue*> values;
-		std::set<IGraphNode*> connectedTo;
-		std::string iGraphNodeRepr();
-		int id;
+		std::string iGraphNodeRepr(const InterferenceGraph& graph);
+		int id;		// node in SSA::interference
+		int index;	// position in SSA::iGraphNodes, -1 once removed
 		IGraphNode* moveTarget;
-		bool visited;
 		int color;
 
 };
@@ -200,9 +187,81 @@ class Register {
 		int offset;
 };
 
+// an arithmetic instruction as cse sees it
+struct valueKey {
+	opcode op;
+	SSAValue* operand1;
+	SSAValue* operand2;
+
+	bool operator==(const valueKey& other) const {
+		return op == other.op && operand1 == other.operand1 && operand2 == other.operand2;
+	}
+};
+
+struct valueKeyHash {
+	size_t operator()(const valueKey& key) const;
+};
+
+typedef struct {
+	int var;
+	SSAValue* prevDef;
+	int prevScope;
+} symbolUndo;
+
+// a variable a scope assigned and its value when the scope ended
+typedef struct {
+	int var;
+	SSAValue* value;
+} scopeDef;
+
+// operand of user that refers to a pending value. slots 0 and 1 are
+// operand1 and operand2, 2 + i is callArgs[i]
+typedef struct {
+	SSAValue* user;
+	int slot;
+} operandUse;
+
+// a while loop being parsed. a variable read inside of it whose value
+// comes from before the loop gets a phi in the header, incomplete until
+// the body is done and it's known what the body assigned
+typedef struct {
+	int bodyDepth;	// scope depth of the body
+	std::unordered_map<int, SSAValue*> phis;
+	std::vector<int> phiOrder;
+} openLoop;
+
+// log sizes when a scope was entered
+typedef struct {
+	size_t valueNumbers;
+	size_t latestWithOpcode;
+	size_t symbols;
+} scopeMark;
+
+// owns every SSAValue, BasicBlock, IGraphNode and Register of one SSA,
+// they are all released together when the SSA is deleted
+class SSAArena {
+	public:
+		ArenaPool<SSAValue> values;
+		ArenaPool<SSAValueInfo> infos;
+		ArenaPool<BasicBlock> blocks;
+		ArenaPool<IGraphNode> nodes;
+		ArenaPool<Register> registers;
+
+		size_t objectCount() const;
+		size_t blockCount() const;
+};
+
 class SSA {
     public:
         SSA(std::string fName);
+		~SSA();
+		SSA(const SSA&) = delete;
+		SSA& operator=(const SSA&) = delete;
+
+		// storage for values and blocks made outside of SSA's own functions
+		SSAValue* allocSSAValue();
+		BasicBlock* allocBasicBlock();
+		const SSAArena& getArena();
         void addSSAValue(SSAValue* newSSAVal);
 		void addSSAConst(SSAValue* newSSAVal);
         SSAValue* SSACreate(opcode operation, SSAValue* x, SSAValue* y);
@@ -224,9 +283,21 @@ class SSA {
 
         // symTable function
         void enterScope();
-        std::unordered_map<std::string, SSAValue*> exitScope();
-        void addSymbol(std::string name, SSAValue* val);
-        SSAValue* findSymbol(std::string name);
+        // appends the variables the scope assigned, in first assignment order
+        void exitScope(std::vector<scopeDef>& assigned);
+        void addSymbol(const std::string& name, SSAValue* val);
+        SSAValue* findSymbol(const std::string& name);
+		// same as above with the id addToVarDecl gave the variable
+		void addSymbol(int var, SSAValue* val);
+		SSAValue* findSymbol(int var);
+
+        // while loops, Braun et al. style. enterLoop goes before the
+        // condition, SSACreateLoopPhi puts a phi for every variable the body
+        // assigned at the tail and exitLoop replaces the phis of variables
+        // that were only read with the value from before the loop
+        void enterLoop();
+        SSAValue* SSACreateLoopPhi(int var, SSAValue* bodyValue);
+        void exitLoop();
 
         // constTable functions
         void addConst(int constVal, SSAValue* constSSAVal);
@@ -234,8 +305,13 @@ class SSA {
 
 
 		// varDeclFunctions
-		void addToVarDecl(std::string varName);
-		bool checkVarDeclList(std::string varName);
+		// returns the variable's id, ids are dense from 0 in declaration order
+		int addToVarDecl(const std::string& varName);
+		bool checkVarDeclList(const std::string& varName);
+		// -1 if varName wasn't declared
+		int findVar(const std::string& varName);
+		int varCount();
+		const std::string& getVarName(int var);
 		// inorder functions
 		void addInOrder(SSAValue* newInst);
 		SSAValue* findPrevDomWithOpcode(opcode operation);
@@ -253,7 +329,7 @@ class SSA {
 	    // basic block functions
 		BasicBlock* createContext();
 		BasicBlock* createBlock();
-		void setJoinType(BasicBlock* block, std::string type);
+		void setJoinType(BasicBlock* block, blockJoin type);
 		void initBlock(BasicBlock* blockToInit);
 		void addInstToBB(SSAValue* inst);
 		void addInstToConstBB(SSAValue* inst);
@@ -268,33 +344,39 @@ class SSA {
 
 		void correctBasicBlockIssues();
 
-		void traverseBasicBlocks(BasicBlock* startBlock);
 		BasicBlock* getBBListHead();
 		BasicBlock* getBBTail();
 
+		// dominator tree of the blocks reachable from bbListHead. BasicBlock::dom
+		// is left as the parser set it
+		void computeDominators();
+		const DominatorTree& getDominators();
+
+		// which values interfere, into interference, and which values are
+		// dead code. replaces walking the blocks backwards from the tail
+		void computeLiveness();
+		// bitset kernels for liveness, the best the cpu supports by default
+		void setBitsetLevel(scanLevel level);
+		scanLevel getBitsetLevel();
+		const InterferenceGraph& getInterference();
+
 		std::string genBBStart(int bbID);
 		
-		bool getInWhile();
-		void setInWhile(bool value);
-		
 		void gen(bool printRegs);
 		//void generateDotLang();
 
 		void reset();
 		
 		void checkOperands(SSAValue* currentInst);
-		void generateLiveRanges(BasicBlock* bb, std::set<SSAValue*>& liveRanges, std::vector<SSAValue*>& phis, SSAValue* instTail, SSAValue* stopAt);
 		void printLiveRanges();
-		void handleTraverseStep(BasicBlock* bb);
 		void generateIGraphNodes();
 		IGraphNode* findInIGraphNodes(SSAValue* toFind);
 		void clusterIGraphNodes();
-		bool checkInterferesWith(IGraphNode* node, SSAValue* instr);
+		bool setsInterfere(int a, int b);
 		int findIndexOfIGraphNode(IGraphNode* toFindNode);
+		void removeIGraphNode(IGraphNode* node);
 		void printClusteredIGraph();
-		void addNewEdges(IGraphNode* newConnection, IGraphNode* oldConnection);
-		void coalescePhi(IGraphNode* node, std::vector<IGraphNode*>& toDelete);
-		IGraphNode* pickNode(std::vector<IGraphNode*> nodes);
+		void coalescePhi(IGraphNode* node, std::vector<std::pair<int, int>>& moves);
 		void colorGraph();
 		int pickColor(IGraphNode* node);
 		void generateRegisters();
@@ -306,25 +388,53 @@ class SSA {
     private:
         int maxID; // current number of SSAValues created
 		int numConsts;
-		int maxBlockID;
 		int iGraphNodeID;
 		static std::unordered_map<tokenType, opcode> brOpConversions;
 
-		bool inWhile;
         SSAValue* instList; // pointer to head of instruction list
         SSAValue* instTail; // pointer to tail of instruction list
         int instListLength;
 
 		int scopeDepth;
 
-        std::vector<std::unordered_map<std::string, SSAValue*>> symTable;
-		std::vector<std::unordered_map<std::string, SSAValue*>> symTableCopy;
-
-		std::vector<std::vector<SSAValue*>> inOrder;
+		// symbol table. currentDef is each variable's value in the innermost
+		// scope that assigned it, defScope that scope's depth. symbolLog
+		// keeps what a scope's first assignment of a variable replaced, so
+		// exitScope can put it back
+		std::unordered_map<std::string, int> varIDs;
+		std::vector<std::string> varNames;
+		std::vector<SSAValue*> currentDef;
+		std::vector<int> defScope;
+		std::vector<symbolUndo> symbolLog;
+
+		// cse tables, scoped like the symbol table. valueNumbers holds the first
+		// instruction with each (opcode, operands) in a visible scope and
+		// latestWithOpcode the last one with each arithmetic opcode. the logs
+		// let exitScope undo what its scope added
+		std::unordered_map<valueKey, SSAValue*, valueKeyHash> valueNumbers;
+		SSAValue* latestWithOpcode[DIVOP + 1];
+		std::vector<valueKey> valueNumberLog;
+		std::vector<std::tuple<opcode, SSAValue*>> latestWithOpcodeLog;
+		std::vector<scopeMark> scopeMarks;
+
+		// open while loops, innermost last. pendingUses are the operands
+		// referring to values that can still be replaced, incomplete phis
+		// and arithmetic computed from them
+		std::vector<openLoop> loops;
+		std::unordered_map<SSAValue*, std::vector<operandUse>> pendingUses;
+		std::vector<SSAValue*> pendingValues;
+		SSAValue* findLoopPhi(size_t loop, int var);
+		SSAValue* valueBeforeLoop(size_t loop, int var);
+		void trackUses(SSAValue* val);
+		void replaceValue(SSAValue* val, SSAValue* with);
 
         std::unordered_map<int, SSAValue*> constTable;
 
+		// every block but the const block, basicBlocks[i]->id == i
 		std::vector<BasicBlock*> basicBlocks;
+		void addBlock(BasicBlock* bb);
+		DominatorTree dominators;
+		const bitsetKernels* bits;
 
 		std::vector<std::string> varDeclList;
 
@@ -334,11 +444,20 @@ class SSA {
 
 		std::string funcName;
 
-		std::unordered_map<SSAValue*, std::set<SSAValue*>> iGraph;
+		// edges between values live at the same time, nodes are indexed
+		// like nodesById
+		InterferenceGraph interference;
+		std::vector<IGraphNode*> nodesById;
+		// phi coalescing, by node id
+		NodeSets coalesced;
 		std::vector<IGraphNode*> iGraphNodes;
 		std::vector<int> virtualRegColors;
 		std::unordered_map<int, Register*> registers;
 
+		SSAArena arena;
+		// an SSAValue and its SSAValueInfo, both from the arena
+		SSAValue* newValue();
+
 };
 
 
@@ -7,6 +7,7 @@
 #include <fstream>
 #include "lexer.h"
 #include "parser.h"
+#include "benchmark.h"
 
 
 #include <algorithm> 
@@ -17,14 +18,14 @@
 // trim from start
 static inline std::string& ltrim(std::string& s) {
 	s.erase(s.begin(), std::find_if(s.begin(), s.end(),
-		std::not1(std::ptr_fun<int, int>(std::isspace))));
+		[](unsigned char ch) { return !std::isspace(ch); }));
 	return s;
 }
 
 // trim from end
 static inline std::string& rtrim(std::string& s) {
 	s.erase(std::find_if(s.rbegin(), s.rend(),
-		std::not1(std::ptr_fun<int, int>(std::isspace))).base(), s.end());
+		[](unsigned char ch) { return !std::isspace(ch); }).base(), s.end());
 	return s;
 }
 
@@ -33,18 +34,17 @@ static inline std::string& trim(std::string& s) {
 	return ltrim(rtrim(s));
 }
 
-std::string compile(std::string fName, bool testMode = false) {
+// compiles whatever source lex was given
+static std::string compileSource(Lexer& lex, bool testMode) {
 	if (!testMode) {
 
 		// Lexer
-		Lexer lex;
-		lex.setFile(fName);
 		lex.tokenize();
 		lex.displayTokens();
 
 		// Parser
 		Parser parser;
-		parser.setTokens(lex.getTokens());
+		parser.setTokens(lex.getTokens(), lex.getPool());
 		parser.setDebug(true);
 		parser.parse();
 		parser.printDotLang();
@@ -52,14 +52,9 @@ std::string compile(std::string fName, bool testMode = false) {
 		parser.reset();
 		return "";
 	} else {
-		// Lexer
-		Lexer lex;
-		lex.setFile(fName);
-		lex.tokenize();
-
-		// Parser
+		// Parser, pulls tokens from the lexer as it goes
 		Parser parser;
-		parser.setTokens(lex.getTokens());
+		parser.setLexer(&lex);
 		parser.setDebug(false);
 		parser.parse();
 
@@ -69,6 +64,20 @@ std::string compile(std::string fName, bool testMode = false) {
 	}
 }
 
+std::string compile(std::string fName, bool testMode = false) {
+	Lexer lex;
+	lex.mapFile(fName);
+	return compileSource(lex, testMode);
+}
+
+// compiles source held in memory, nothing is read from disk. testMode has
+// no default so compile(fileName, true) can't silently pick this overload
+std::string compile(const char* source, size_t length, bool testMode) {
+	Lexer lex;
+	lex.setSource(source, length);
+	return compileSource(lex, testMode);
+}
+
 
 bool confirmResults(std::string baseFileName) {
 	std::string testFile = baseFileName + "_test.tiny";
@@ -149,6 +158,11 @@ std::tuple<bool, std::string> testCompiler() {
 }
 
 int main(int argc, char* argv[]) {
+	if (argc > 1 && std::string(argv[1]) == "--bench") {
+		runBenchmarks(argc - 2, argv + 2);
+		return 0;
+	}
+
 	std::cout << "Starting compilation...\n";
 	std::string fName = "tests/testSSA.tiny";//argv[0];
 
@@ -2,47 +2,179 @@
 #include <string>
 #include <iostream>
 
+static const char* tokenEnumStrings[34] = {
+	"LET",
+	"VAR",
+	"IF",
+	"THEN",
+	"ELSE",
+	"FI",
+	"WHILE",
+	"DO",
+	"OD",
+	"VOID",
+	"FUNCTION",
+	"CALL",
+	"RETURN",
+	"MAIN",
+	"ADD",
+	"SUB",
+	"MUL",
+	"DIV",
+	"EQ",
+	"NEQ",
+	"LT",
+	"LE",
+	"GT",
+	"GE",
+	"ASSIGN",
+	"L_PAREN",
+	"R_PAREN",
+	"L_BRACE",
+	"R_BRACE",
+	"COMMA",
+	"SEMICOLON",
+	"PERIOD",
+	"IDENT",
+	"NUMBER"
+};
+
+// source spelling of every token type with a fixed spelling
+static const char* tokenSpellings[34] = {
+	"let",
+	"var",
+	"if",
+	"then",
+	"else",
+	"fi",
+	"while",
+	"do",
+	"od",
+	"void",
+	"function",
+	"call",
+	"return",
+	"main",
+	"+",
+	"-",
+	"*",
+	"/",
+	"==",
+	"!=",
+	"<",
+	"<=",
+	">",
+	">=",
+	"<-",
+	"(",
+	")",
+	"{",
+	"}",
+	",",
+	";",
+	".",
+	"",
+	""
+};
+
 std::string getTextForEnum(int enumVal) {
-	Token* t = new Token();
-	return t->getTextForEnum(enumVal);
+	return tokenEnumStrings[enumVal];
 }
 
-Token::Token() {
-	type = ADD;
-	lineNumber = 0;
-	columnNumber = 0;
-	value = "";
+std::string_view getSpellingForEnum(int enumVal) {
+	return tokenSpellings[enumVal];
 }
 
-Token::Token(tokenType tokenType, int ln, int cn, std::string val) {
+Token::Token(tokenType tokenType, unsigned int ln, unsigned int cn, unsigned int valIndex) {
 	type = tokenType;
 	lineNumber = ln;
 	columnNumber = cn;
-	value = val;
+	valueIndex = valIndex;
 }
 
-std::string Token::getTextForEnum(int enumVal) {
-	return Token::tokenEnumStrings[enumVal];
+tokenType Token::getType() const {
+	return type;
 }
 
-void Token::displayToken(int id) {
-	std::string tokenType = Token::getTextForEnum(type);
-	std::string location = std::to_string(lineNumber) + "[" +
-		std::to_string(columnNumber) + "]";
+unsigned int Token::getLineNumber() const {
+	return lineNumber;
+}
 
-	printf("%-6d", id);
-	printf("%-12s", tokenType.c_str());
-	printf("%-11s", location.c_str());
-	printf("%-11s", value.c_str());
-	printf("%s", "\n");
+unsigned int Token::getColumnNumber() const {
+	return columnNumber;
+}
+
+unsigned int Token::getValueIndex() const {
+	return valueIndex;
+}
 
+// token pool
 
+TokenPool::TokenPool() {
+	owning = false;
 }
 
-tokenType Token::getType() {
-	return type;
+unsigned int TokenPool::intern(std::string_view value) {
+	auto found = indices.find(value);
+	if (found != indices.end()) {
+		return found->second;
+	}
+	if (owning) {
+		storage.emplace_back(value);
+		value = storage.back();
+	}
+	unsigned int valIndex = (unsigned int)values.size();
+	values.push_back(value);
+	indices.insert({ value, valIndex });
+	return valIndex;
+}
+
+void TokenPool::ownValues() {
+	if (owning) {
+		return;
+	}
+	owning = true;
+	indices.clear();
+	for (unsigned int i = 0; i < values.size(); i++) {
+		storage.emplace_back(values[i]);
+		values[i] = storage.back();
+		indices.insert({ values[i], i });
+	}
 }
 
-std::string Token::getValue() {
-	return value;
-}
\ No newline at end of file
+std::string_view TokenPool::getValue(const Token& token) const {
+	if (token.getValueIndex() == Token::NO_VALUE) {
+		return getSpellingForEnum(token.getType());
+	}
+	return values[token.getValueIndex()];
+}
+
+std::string_view TokenPool::at(unsigned int valIndex) const {
+	return values[valIndex];
+}
+
+size_t TokenPool::size() const {
+	return values.size();
+}
+
+size_t TokenPool::memoryUsage() const {
+	// vector storage plus an estimate of the hash nodes and buckets
+	size_t nodeSize = sizeof(std::pair<const std::string_view, unsigned int>) + sizeof(void*);
+	return values.capacity() * sizeof(std::string_view) +
+		indices.size() * nodeSize +
+		indices.bucket_count() * sizeof(void*) +
+		storage.size() * sizeof(std::string);
+}
+
+void TokenPool::displayToken(const Token& token, int id) const {
+	std::string tokenType = getTextForEnum(token.getType());
+	std::string location = std::to_string(token.getLineNumber()) + "[" +
+		std::to_string(token.getColumnNumber()) + "]";
+	std::string_view value = getValue(token);
+
+	printf("%-6d", id);
+	printf("%-12s", tokenType.c_str());
+	printf("%-11s", location.c_str());
+	printf("%-11.*s", (int)value.size(), value.data());
+	printf("%s", "\n");
+}
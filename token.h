@@ -2,6 +2,11 @@
 #define __TOKEN_H__
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <deque>
+#include <type_traits>
 
 enum tokenType {
 	LET			= 0, // let
@@ -41,61 +46,51 @@ enum tokenType {
 };
 
 std::string getTextForEnum(int enumVal);
+std::string_view getSpellingForEnum(int enumVal);
 
+// 16 byte plain old data token. Identifier and number values live in a
+// TokenPool, every other token type is spelled the same every time.
 class Token {
 	public:
-		Token();
-		Token(tokenType type, int ln, int cn, std::string val);
-		void displayToken(int id);
-		tokenType getType();
-		std::string getValue();
+		static constexpr unsigned int NO_VALUE = 0xFFFFFFFF;
 
-		std::string getTextForEnum(int enumVal);
+		Token() = default;
+		Token(tokenType type, unsigned int ln, unsigned int cn, unsigned int valIndex = NO_VALUE);
+		tokenType getType() const;
+		unsigned int getLineNumber() const;
+		unsigned int getColumnNumber() const;
+		unsigned int getValueIndex() const;
 
 	private:
 		tokenType type;
-		int lineNumber;
-		int columnNumber;
-		std::string value;
+		unsigned int lineNumber;
+		unsigned int columnNumber;
+		unsigned int valueIndex; // index into TokenPool for IDENT and NUMBER
+};
 
-		std::string tokenEnumStrings[34] = {
-			"LET",
-			"VAR",
-			"IF",
-			"THEN",
-			"ELSE",
-			"FI",
-			"WHILE",
-			"DO",
-			"OD",
-			"VOID",
-			"FUNCTION",
-			"CALL",
-			"RETURN",
-			"MAIN",
-			"ADD",
-			"SUB",
-			"MUL",
-			"DIV",
-			"EQ",
-			"NEQ",
-			"LT",
-			"LE",
-			"GT",
-			"GE",
-			"ASSIGN",
-			"L_PAREN",
-			"R_PAREN",
-			"L_BRACE",
-			"R_BRACE",
-			"COMMA",
-			"SEMICOLON",
-			"PERIOD",
-			"IDENT",
-			"NUMBER"
-		};
+static_assert(sizeof(Token) == 16, "Token should stay 16 bytes");
+static_assert(std::is_trivial<Token>::value, "Token should stay plain old data");
 
+// interns identifier and number spellings so equal names share an index,
+// values are views into the lexer's source buffer unless the pool owns them
+class TokenPool {
+	public:
+		TokenPool();
+		unsigned int intern(std::string_view value);
+		// copies every value, now and on later interns, so the pool no
+		// longer depends on the source buffer staying unchanged
+		void ownValues();
+		std::string_view getValue(const Token& token) const;
+		std::string_view at(unsigned int valIndex) const;
+		size_t size() const;
+		size_t memoryUsage() const;
+		void displayToken(const Token& token, int id) const;
 
+	private:
+		std::vector<std::string_view> values;
+		std::unordered_map<std::string_view, unsigned int> indices;
+		bool owning;
+		std::deque<std::string> storage; // backing for owned values, never moves
 };
 
 